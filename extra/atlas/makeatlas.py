@@ -0,0 +1,225 @@
+#!/usr/bin/env python
+
+"""Build the segment resources from the segment images.
+
+Each digit size has one image per segment orientation (vertical, 9 to 81
+degrees, horizontal, 99 to 171 degrees, in segment_orientation_t order).
+
+Two outputs are produced:
+- One atlas image per digit size, with the vertical and horizontal segments
+  side by side, top-aligned with no padding. These are the only segment
+  bitmaps needed at runtime, to compose static digits. digit_images compute
+  the position of each image from its segment size table, so the two must stay
+  in sync.
+- A C source file with the spans (horizontal runs of white pixels) of every
+  orientation of every size, used to draw moving segments (see
+  src/digits/segment_spans.h). An orientation that is an exact copy, or an
+  exact horizontal mirror, of a previous one of the same size reuses its
+  spans instead of storing them again.
+
+Only 8 bit RGBA, non-interlaced PNG files are supported as input, which is
+what the segment images are.
+"""
+
+import os.path
+import struct
+import sys
+import zlib
+
+SIZES = ['big', 'med', 'small']
+
+# Orientations packed in the atlas (SO_VERTICAL and SO_HORIZONTAL)
+ATLAS_ORIENTATIONS = [0, 10]
+
+def orientationFiles(prefix):
+    "Return the image file names of a digit size, in orientation order"
+    return ([prefix + '_vert.png'] +
+            ['%s%i.png' % (prefix, index) for index in range(9)] +
+            [prefix + '_horiz.png'] +
+            ['%s%i.png' % (prefix, index) for index in range(9, 18)])
+
+def paeth(left, up, upLeft):
+    "PNG Paeth predictor"
+    estimate = left + up - upLeft
+    distLeft = abs(estimate - left)
+    distUp = abs(estimate - up)
+    distUpLeft = abs(estimate - upLeft)
+    if distLeft <= distUp and distLeft <= distUpLeft:
+        return left
+    if distUp <= distUpLeft:
+        return up
+    return upLeft
+
+def readPng(path):
+    "Return (width, height, rows) of a PNG file, rows being RGBA bytearrays"
+    with open(path, 'rb') as inFile:
+        data = inFile.read()
+    position = 8
+    compressed = b''
+    while position < len(data):
+        length, chunkType = struct.unpack('>I4s', data[position:position + 8])
+        chunk = data[position + 8:position + 8 + length]
+        position += 12 + length
+        if chunkType == b'IHDR':
+            (width, height, depth, colorType,
+             _, _, interlace) = struct.unpack('>IIBBBBB', chunk)
+            if depth != 8 or colorType != 6 or interlace != 0:
+                raise ValueError('%s: unsupported PNG format' % path)
+        elif chunkType == b'IDAT':
+            compressed += chunk
+    raw = bytearray(zlib.decompress(compressed))
+    stride = width * 4
+    rows = []
+    previous = bytearray(stride)
+    offset = 0
+    for _ in range(height):
+        rowFilter = raw[offset]
+        row = raw[offset + 1:offset + 1 + stride]
+        offset += 1 + stride
+        for x in range(stride):
+            left = row[x - 4] if x >= 4 else 0
+            up = previous[x]
+            upLeft = previous[x - 4] if x >= 4 else 0
+            if rowFilter == 1:
+                row[x] = (row[x] + left) & 0xff
+            elif rowFilter == 2:
+                row[x] = (row[x] + up) & 0xff
+            elif rowFilter == 3:
+                row[x] = (row[x] + (left + up) // 2) & 0xff
+            elif rowFilter == 4:
+                row[x] = (row[x] + paeth(left, up, upLeft)) & 0xff
+        rows.append(row)
+        previous = row
+    return width, height, rows
+
+def pngChunk(chunkType, data):
+    "Return a complete PNG chunk"
+    return (struct.pack('>I', len(data)) + chunkType + data +
+            struct.pack('>I', zlib.crc32(chunkType + data) & 0xffffffff))
+
+def writePng(path, width, height, rows):
+    "Write RGBA rows as a PNG file"
+    raw = bytearray()
+    for row in rows:
+        raw.append(0)
+        raw.extend(row)
+    with open(path, 'wb') as outFile:
+        outFile.write(b'\x89PNG\r\n\x1a\n' +
+                      pngChunk(b'IHDR', struct.pack('>IIBBBBB', width, height,
+                                                    8, 6, 0, 0, 0)) +
+                      pngChunk(b'IDAT', zlib.compress(bytes(raw), 9)) +
+                      pngChunk(b'IEND', b''))
+
+def isWhite(row, x):
+    "Same conversion as the SDK: opaque light pixels are white"
+    return row[x * 4] >= 128 and row[x * 4 + 3] >= 128
+
+def getSpans(image):
+    "Return the (y, x, length) white runs of an image"
+    width, height, rows = image
+    spans = []
+    for y in range(height):
+        x = 0
+        while x < width:
+            if not isWhite(rows[y], x):
+                x += 1
+                continue
+            start = x
+            while x < width and isWhite(rows[y], x):
+                x += 1
+            spans.append((y, start, x - start))
+    return spans
+
+def mirrorWidth(spans, original):
+    """Return the width across which spans mirror original horizontally, or
+    None if they are not its mirror"""
+    if not spans or len(spans) != len(original):
+        return None
+    # The leftmost span of the first row mirrors the rightmost one
+    y, x, length = spans[0]
+    rightmost = max(span for span in original if span[0] == y)
+    width = x + rightmost[1] + rightmost[2]
+    mirrored = sorted((spanY, width - spanX - spanLength, spanLength)
+                      for spanY, spanX, spanLength in original)
+    return width if mirrored == spans else None
+
+def shareSpans(orientations):
+    """Return the spans to store for a size, and for each orientation its
+    (first span, count, mirror width) in them"""
+    stored = []
+    entries = []
+    for spans in orientations:
+        entry = None
+        for previous, (first, count, mirror) in zip(orientations, entries):
+            if mirror:
+                continue
+            if spans == previous:
+                entry = (first, count, 0)
+            else:
+                width = mirrorWidth(spans, previous)
+                if width:
+                    entry = (first, count, width)
+            if entry:
+                break
+        if not entry:
+            entry = (len(stored), len(spans), 0)
+            stored += spans
+        entries.append(entry)
+    return stored, entries
+
+def makeAtlas(images, outPath):
+    "Pack the images into outPath"
+    width = sum(image[0] for image in images)
+    height = max(image[1] for image in images)
+    rows = [bytearray(width * 4) for _ in range(height)]
+    left = 0
+    for imageWidth, imageHeight, imageRows in images:
+        for y in range(imageHeight):
+            rows[y][left * 4:(left + imageWidth) * 4] = imageRows[y]
+        left += imageWidth
+    writePng(outPath, width, height, rows)
+
+def writeSpans(spansBySize, outPath):
+    "Write the span tables as C source"
+    with open(outPath, 'w') as output:
+        output.write('/* GENERATED FILE DO NOT MODIFY */\n'
+                     '#include <pebble.h>\n'
+                     '\n'
+                     '#include "segment_spans.h"\n'
+                     '\n'
+                     '#ifndef PROCEDURAL_SEGMENTS\n')
+        entriesBySize = []
+        for prefix, orientations in zip(SIZES, spansBySize):
+            stored, entries = shareSpans(orientations)
+            entriesBySize.append(entries)
+            output.write('static const segment_span_t %s_spans[] = {\n' % prefix)
+            for span in stored:
+                output.write('    {%i, %i, %i},\n' % span)
+            output.write('};\n\n')
+        output.write('const segment_spans_t segment_spans'
+                     '[DIGITS_SIZE_COUNT][SEGMENTS_ORIENTATION_COUNT] = {\n')
+        for prefix, entries in zip(SIZES, entriesBySize):
+            output.write('    {\n')
+            for first, count, mirror in entries:
+                output.write('        {%s_spans + %i, %i, %i},\n'
+                             % (prefix, first, count, mirror))
+            output.write('    },\n')
+        output.write('};\n'
+                     '#endif\n')
+
+def main(imagesDir, spansPath):
+    """Write segments_<size>.png for each digit size in imagesDir, and the
+    span tables in spansPath"""
+    spansBySize = []
+    for prefix in SIZES:
+        images = [readPng(os.path.join(imagesDir, fileName))
+                  for fileName in orientationFiles(prefix)]
+        makeAtlas([images[index] for index in ATLAS_ORIENTATIONS],
+                  os.path.join(imagesDir, 'segments_%s.png' % prefix))
+        spansBySize.append([getSpans(image) for image in images])
+    writeSpans(spansBySize, spansPath)
+
+if __name__ == '__main__':
+    main(sys.argv[1] if len(sys.argv) > 1 else os.path.join('resources', 'images'),
+         sys.argv[2] if len(sys.argv) > 2
+         else os.path.join('src', 'digits', 'segment_spans.auto.c'))
@@ -39,9 +39,11 @@ def generateCSource(config, defines):
                  '%(keyDefines)s\n'
                  'static config_callback_t config_callback;\n'
                  'static void* config_callback_data;\n'
+                 'static cfg_changes_t config_changes;\n'
                  '%(cachedvars)s'
                  'static void in_recv_handler(DictionaryIterator* iterator, void* context);\n'
                  'static void update_config();\n'
+                 'static void set_changed(unsigned key);\n'
                  '%(appMessageHead)s'
                  '%(atoiImplHead)s'
                  'static void in_recv_handler(DictionaryIterator* iterator, void* context)\n'
@@ -55,7 +57,12 @@ def generateCSource(config, defines):
                  'if (handled_a_value) { update_config(); }\n'
                  '}\n'
                  '%(atoiImpl)s'
-                 'static void update_config(void) { if (config_callback) { config_callback(config_callback_data); } }\n'
+                 'static void update_config(void)\n'
+                 '{\n'
+                 'if (config_callback) { config_callback(config_callback_data, &config_changes); }\n'
+                 'memset(&config_changes, 0, sizeof(config_changes));\n'
+                 '}\n'
+                 'static void set_changed(unsigned key) { config_changes.bits[key / 32] |= 1u << (key %% 32); }\n'
                  '%(getters)s'
                  'void cfg_init(config_callback_t callback, void* data)\n'
                  '{\n'
@@ -178,7 +185,7 @@ def getRecvHandlers(defines, entries):
             'checkbox': generateBoolRecv,
             'select': generateIntRecv,
             'radio': generateIntRecv,
-            'oneshot': generateBoolRecv}
+            'oneshot': generateOneshotRecv}
     result = ''
     for section in entries:
         for entry in section[1:]:
@@ -189,16 +196,31 @@ def getRecvHandlers(defines, entries):
 
 def generateBoolRecv(defines, entryDefine, entryValues):
     "Generate a bool value receiver"
+    return ('if (%(define)s_value != (strcmp(tuple->value->cstring, "1") == 0)) {\n'
+            '%(define)s_value = !%(define)s_value;\n'
+            'persist_write_bool(%(defineUpper)s, %(define)s_value);\n'
+            'set_changed(%(defineUpper)s);\n'
+            '}\n'
+            'return true;\n' %
+            { 'define': entryDefine,
+              'defineUpper': entryDefine.upper()})
+
+def generateOneshotRecv(defines, entryDefine, entryValues):
+    "Generate a oneshot value receiver (changed every time it is set)"
     return ('%(define)s_value = strcmp(tuple->value->cstring, "1") == 0;\n'
             'persist_write_bool(%(defineUpper)s, %(define)s_value);\n'
+            'if (%(define)s_value) { set_changed(%(defineUpper)s); }\n'
             'return true;\n' %
             { 'define': entryDefine,
               'defineUpper': entryDefine.upper()})
 
 def generateIntRecv(defines, entryDefine, entryValues):
     "Generate an enum value receiver"
-    return ('%(define)s_value = str_to_int(tuple->value->cstring);\n'
+    return ('if (%(define)s_value != str_to_int(tuple->value->cstring)) {\n'
+            '%(define)s_value = str_to_int(tuple->value->cstring);\n'
             'persist_write_int(%(defineUpper)s, %(define)s_value);\n'
+            'set_changed(%(defineUpper)s);\n'
+            '}\n'
             'return true;\n' %
             { 'define': entryDefine,
               'defineUpper': entryDefine.upper()})
@@ -17,7 +17,13 @@ def generateCHeader(config, defines):
                  '\n'
                  '%(defines)s'
                  '\n'
-                 'typedef void(*config_callback_t)(void* data);\n'
+                 '%(keyDefines)s'
+                 '\n'
+                 '/* Set of keys changed by a configuration message */\n'
+                 'typedef struct { uint32_t bits[(CFG_KEY_COUNT + 31) / 32]; } cfg_changes_t;\n'
+                 'static inline bool cfg_changed(const cfg_changes_t* changes, unsigned key) { return (changes->bits[key / 32] >> (key %% 32)) & 1; }\n'
+                 '\n'
+                 'typedef void(*config_callback_t)(void* data, const cfg_changes_t* changes);\n'
                  '\n'
                  '%(funcHeaders)s'
                  '\n'
@@ -27,6 +33,7 @@ def generateCHeader(config, defines):
                  '\n'
                  '#endif\n'
                  % { 'defines': getHeaderDefines(defines),
+                     'keyDefines': getHeaderKeyDefines(defines),
                      'funcHeaders': getHeaderFunctions(entries),
                      'appMessageHandler': appMessage})
     output.close()
@@ -39,6 +46,15 @@ def getHeaderDefines(defines):
         result += "#define %s %i\n" % (define.upper(), allDefines[define])
     return result
 
+def getHeaderKeyDefines(defines):
+    "Prepare the keys #define, prefixed with CFG_KEY_"
+    keys = cfgdef.getAllKeys(defines)
+    result = ''
+    for define in sorted(keys.keys()):
+        result += "#define CFG_KEY_%s %i\n" % (define.upper(), keys[define])
+    result += "#define CFG_KEY_COUNT %i\n" % (max(keys.values()) + 1)
+    return result
+
 def getHeaderFunctions(entries):
     "Prepare all function declarations"
     result = ''
@@ -0,0 +1,459 @@
+/** @file
+ * Segment blitter benchmark and check.
+ *
+ * Compare the word-based bitmap_or_bitmap() used to compose digits offscreen
+ * with the generic graphics_draw_bitmap_in_rect() path, and with a plain
+ * pixel-by-pixel reference.
+ *
+ * The check draws every segment bitmap of every digit size at all 32 word
+ * alignments, with and without clipping, over a random background, and
+ * exits with a non-zero status if any output differ from the reference or
+ * from the generic path. The benchmark then reports the average time of a
+ * single segment blit for each method and digit size.
+ *
+ * Usage: bench-blit [--check] [--reps N]
+ *
+ * Must be run from the repository root (or with LIVEDIGITS_HOST_RESOURCES set)
+ * to find the segment images.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+#include "utils.h"
+#include "digits/digit_images.h"
+#include "digits/digit_info.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Parameters of the generic path update proc */
+typedef struct {
+    GBitmap* bitmap;
+    GRect rect;
+    unsigned reps;
+} generic_blit_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+static
+const char* const size_names[DIGITS_SIZE_COUNT] = {
+    "big", "medium", "small"
+};
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+/** Blit done by generic_update() */
+static
+generic_blit_t generic_blit;
+
+/** State of the pseudo-random generator */
+static
+uint32_t random_state = 0x12345678u;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Return a pseudo-random word (xorshift32) */
+static
+uint32_t
+next_random(void);
+
+/** Pixel by pixel equivalent of bitmap_or_bitmap() */
+static
+void
+reference_or_bitmap(GBitmap* target,
+                    const GBitmap* source,
+                    GPoint origin,
+                    GRect clip);
+
+/** Draw generic_blit through graphics_draw_bitmap_in_rect() */
+static
+void
+generic_update(Layer* layer,
+               GContext* ctx);
+
+/** Return true if the pixels of two bitmaps with the same geometry match */
+static
+bool
+same_pixels(const GBitmap* first,
+            const GBitmap* second);
+
+/** Check one blit against the reference and, if unclipped, the generic path.
+ *
+ * @return true if all outputs match
+ */
+static
+bool
+check_blit(GBitmap* source,
+           GPoint origin,
+           GRect clip,
+           Layer* layer);
+
+/** Run the check on all segments.
+ *
+ * @return The number of mismatches
+ */
+static
+unsigned
+check_all(Layer* layer);
+
+/** Measure the three blit methods for one digit size. */
+static
+void
+bench_size(digit_size_t size,
+           Layer* layer,
+           unsigned reps);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+uint32_t
+next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static
+void
+reference_or_bitmap(GBitmap* target,
+                    const GBitmap* source,
+                    GPoint origin,
+                    GRect clip)
+{
+    GRect area = rect_intersection(GRect(origin.x, origin.y,
+                                         source->bounds.size.w,
+                                         source->bounds.size.h),
+                                   clip);
+    uint8_t* target_data = (uint8_t*) target->addr;
+    const uint8_t* source_data = (const uint8_t*) source->addr;
+
+    for (int y = area.origin.y;
+         y < area.origin.y + area.size.h;
+         ++y) {
+        uint8_t* target_row = target_data +
+                              (target->bounds.origin.y + y) *
+                              target->row_size_bytes;
+        const uint8_t* source_row = source_data +
+                                    (source->bounds.origin.y + y - origin.y) *
+                                    source->row_size_bytes;
+
+        for (int x = area.origin.x;
+             x < area.origin.x + area.size.w;
+             ++x) {
+            int source_x = source->bounds.origin.x + x - origin.x;
+
+            if ((source_row[source_x >> 3] >> (source_x & 7)) & 1) {
+                int target_x = target->bounds.origin.x + x;
+                target_row[target_x >> 3] |= 1u << (target_x & 7);
+            }
+        }
+    }
+}
+
+static
+void
+generic_update(Layer* layer,
+               GContext* ctx)
+{
+    graphics_context_set_compositing_mode(ctx,
+                                          GCompOpOr);
+
+    for (unsigned rep = 0;
+         rep < generic_blit.reps;
+         ++rep) {
+        graphics_draw_bitmap_in_rect(ctx,
+                                     generic_blit.bitmap,
+                                     generic_blit.rect);
+    }
+}
+
+static
+bool
+same_pixels(const GBitmap* first,
+            const GBitmap* second)
+{
+    for (int y = 0;
+         y < first->bounds.size.h;
+         ++y) {
+        const uint8_t* first_row = (const uint8_t*) first->addr +
+                                   y * first->row_size_bytes;
+        const uint8_t* second_row = (const uint8_t*) second->addr +
+                                    y * second->row_size_bytes;
+
+        for (int x = 0;
+             x < first->bounds.size.w;
+             ++x) {
+            if (((first_row[x >> 3] ^ second_row[x >> 3]) >> (x & 7)) & 1) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static
+bool
+check_blit(GBitmap* source,
+           GPoint origin,
+           GRect clip,
+           Layer* layer)
+{
+    GSize screen_size = GSize(host_screen_width,
+                              host_screen_height);
+    GBitmap* expected = gbitmap_create_blank(screen_size);
+    GBitmap* actual = gbitmap_create_blank(screen_size);
+    size_t data_size = expected->row_size_bytes * screen_size.h;
+
+    for (size_t byte = 0;
+         byte < data_size;
+         ++byte) {
+        ((uint8_t*) expected->addr)[byte] = next_random();
+    }
+
+    memcpy(actual->addr,
+           expected->addr,
+           data_size);
+    reference_or_bitmap(expected,
+                        source,
+                        origin,
+                        clip);
+    bitmap_or_bitmap(actual,
+                     source,
+                     origin,
+                     clip);
+    bool result = same_pixels(expected,
+                              actual);
+
+    if (clip.size.w == screen_size.w && clip.size.h == screen_size.h) {
+        // Generic path, over a black screen
+        memset(actual->addr,
+               0,
+               data_size);
+        bitmap_or_bitmap(actual,
+                         source,
+                         origin,
+                         clip);
+        generic_blit.bitmap = source;
+        generic_blit.rect = GRect(origin.x, origin.y,
+                                  source->bounds.size.w,
+                                  source->bounds.size.h);
+        generic_blit.reps = 1;
+        host_render_layer(layer);
+        result &= same_pixels(host_get_framebuffer(),
+                              actual);
+    }
+
+    gbitmap_destroy(expected);
+    gbitmap_destroy(actual);
+    return result;
+}
+
+static
+unsigned
+check_all(Layer* layer)
+{
+    unsigned checks = 0;
+    unsigned failures = 0;
+    GRect full_clip = GRect(0, 0,
+                            host_screen_width, host_screen_height);
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        for (int orientation = 0;
+             orientation < SEGMENTS_ORIENTATION_COUNT;
+             ++orientation) {
+            GSize segment_size;
+            GBitmap* source = segment_get_image(size,
+                                                orientation,
+                                                &segment_size);
+
+            if (!source) {
+                // Only available as spans
+                continue;
+            }
+
+            for (int x = 0;
+                 x < 32;
+                 ++x) {
+                GPoint origin = GPoint(40 + x, 50 + x % 3);
+                // Clip a few pixels on each side, at another alignment
+                GRect clip = GRect(origin.x + 1 + x % 5, origin.y + 2,
+                                   segment_size.w - 2 - x % 7,
+                                   segment_size.h - 3);
+                bool passed = check_blit(source,
+                                         origin,
+                                         full_clip,
+                                         layer);
+                passed &= check_blit(source,
+                                     origin,
+                                     clip,
+                                     layer);
+                checks += 2;
+
+                if (!passed) {
+                    ++failures;
+                    printf("MISMATCH %s orientation %d x %d\n",
+                           size_names[size],
+                           orientation,
+                           origin.x);
+                }
+            }
+        }
+    }
+
+    printf("# check: %u blits, %u mismatches\n",
+           checks,
+           failures);
+    return failures;
+}
+
+static
+void
+bench_size(digit_size_t size,
+           Layer* layer,
+           unsigned reps)
+{
+    GBitmap* canvas = gbitmap_create_blank(GSize(host_screen_width,
+                                                 host_screen_height));
+    GRect clip = canvas->bounds;
+    double generic_ns = 0;
+    double reference_ns = 0;
+    double word_ns = 0;
+    unsigned long blits = 0;
+
+    for (int orientation = 0;
+         orientation < SEGMENTS_ORIENTATION_COUNT;
+         ++orientation) {
+        GSize segment_size;
+        GBitmap* source = segment_get_image(size,
+                                            orientation,
+                                            &segment_size);
+
+        if (!source) {
+            continue;
+        }
+
+        for (int x = 0;
+             x < 32;
+             ++x) {
+            GPoint origin = GPoint(40 + x, 50);
+
+            generic_blit.bitmap = source;
+            generic_blit.rect = GRect(origin.x, origin.y,
+                                      segment_size.w, segment_size.h);
+            generic_blit.reps = reps;
+            double start = host_now_ns();
+            host_render_layer(layer);
+            generic_ns += host_now_ns() - start;
+
+            start = host_now_ns();
+
+            for (unsigned rep = 0;
+                 rep < reps;
+                 ++rep) {
+                reference_or_bitmap(canvas,
+                                    source,
+                                    origin,
+                                    clip);
+            }
+
+            reference_ns += host_now_ns() - start;
+            start = host_now_ns();
+
+            for (unsigned rep = 0;
+                 rep < reps;
+                 ++rep) {
+                bitmap_or_bitmap(canvas,
+                                 source,
+                                 origin,
+                                 clip);
+            }
+
+            word_ns += host_now_ns() - start;
+            blits += reps;
+        }
+    }
+
+    printf("%s: generic %.1f ns/blit, reference %.1f ns/blit, "
+           "word %.1f ns/blit\n",
+           size_names[size],
+           generic_ns / blits,
+           reference_ns / blits,
+           word_ns / blits);
+    gbitmap_destroy(canvas);
+}
+
+// ======
+// MAIN =
+// ======
+
+int
+main(int argc,
+     char** argv)
+{
+    bool check_only = false;
+    unsigned reps = 200;
+
+    for (int arg = 1;
+         arg < argc;
+         ++arg) {
+        if (strcmp(argv[arg], "--check") == 0) {
+            check_only = true;
+        } else if (strcmp(argv[arg], "--reps") == 0 && arg + 1 < argc) {
+            reps = strtoul(argv[++arg], NULL, 10);
+            reps = reps ? reps : 1;
+        } else {
+            fprintf(stderr, "Usage: %s [--check] [--reps N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Layer* layer = layer_create(GRect(0, 0,
+                                      host_screen_width, host_screen_height));
+    layer_set_update_proc(layer,
+                          generic_update);
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        segment_load_images(size);
+    }
+
+    unsigned failures = check_all(layer);
+
+    if (!check_only) {
+        for (int size = 0;
+             size < DIGITS_SIZE_COUNT;
+             ++size) {
+            bench_size(size,
+                       layer,
+                       reps);
+        }
+    }
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        segment_unload_images(size);
+    }
+
+    layer_destroy(layer);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+/** @file
+ * Settings change benchmark.
+ *
+ * Load the main window like the application does, with every widget enabled
+ * and the 12h clock style (the day time is only displayed in 12h style), then
+ * send configuration messages that toggle one setting at a time between two
+ * values. For each setting the tool reports the average wall-clock time of a
+ * reconfiguration, and the number of heap blocks allocated and released by it.
+ *
+ * A reconfiguration covers the whole message: decoding, the settings callback
+ * and the rendering of the resulting frame. The "message only" line sends a
+ * key the application does not know, which gives the cost of the host message
+ * itself.
+ *
+ * Usage: bench-config [--reps N]
+ *
+ * Must be run from the repository root (or with LIVEDIGITS_HOST_RESOURCES set)
+ * to find the images.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+#include "config.h"
+#include "mainwindow.h"
+#include "utils.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** A setting toggled by the benchmark */
+typedef struct {
+    const char* name;
+    uint32_t key;
+    /** The two values sent in turn */
+    const char* values[2];
+} bench_setting_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Key no setting uses */
+#define UNKNOWN_KEY 1000
+
+/** Settings sent once before measuring: every widget displayed */
+static
+const uint32_t setup_keys[] = {
+    CFG_KEY_DISPLAY_WIDGETS,
+    CFG_KEY_DATE_POSITION,
+    CFG_KEY_SECONDS_POSITION,
+    CFG_KEY_SECONDS_STYLE,
+    CFG_KEY_BLUETOOTH_POSITION,
+    CFG_KEY_BATTERY_POSITION
+};
+
+static
+const char* const setup_values[] = {
+    "0", "1", "2", "2", "3", "4"
+};
+
+static
+const bench_setting_t settings[] = {
+    {"message only", UNKNOWN_KEY, {"0", "1"}},
+    {"vibrate every", CFG_KEY_VIBRATE_EVERY, {"1", "0"}},
+    {"anim speed", CFG_KEY_ANIM_SPEED_NORMAL, {"0", "3"}},
+    {"skip digits", CFG_KEY_SKIP_DIGITS, {"1", "0"}},
+    {"smoothness", CFG_KEY_ANIM_SMOOTHNESS, {"2", "1"}},
+    {"hour position", CFG_KEY_HOUR_POSITION, {"1", "0"}},
+    {"base layout", CFG_KEY_BASE_LAYOUT, {"1", "0"}},
+    {"date style", CFG_KEY_DATE_STYLE, {"1", "0"}},
+    {"seconds style", CFG_KEY_SECONDS_STYLE, {"0", "2"}},
+    {"battery position", CFG_KEY_BATTERY_POSITION, {"0", "4"}},
+    {"invert colors", CFG_KEY_INVERT_COLORS, {"1", "0"}},
+    {"display daytime", CFG_KEY_DISPLAY_DAYTIME, {"1", "0"}}
+};
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Toggle a setting and print the average cost of a reconfiguration */
+static
+void
+bench_setting(const bench_setting_t* setting,
+              unsigned reps);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+bench_setting(const bench_setting_t* setting,
+              unsigned reps)
+{
+    host_reset_stats();
+    double start = host_now_ns();
+
+    for (unsigned rep = 0;
+         rep < reps;
+         ++rep) {
+        for (unsigned index = 0;
+             index < 2;
+             ++index) {
+            host_send_app_message(&setting->key,
+                                  &setting->values[index],
+                                  1);
+        }
+    }
+
+    double elapsed = host_now_ns() - start;
+    const host_stats_t* stats = host_get_stats();
+    unsigned count = reps * 2;
+    printf("%-18s %10.0f ns %8.1f allocations %8.1f releases\n",
+           setting->name,
+           elapsed / count,
+           (double) stats->heap_allocations / count,
+           (double) stats->heap_releases / count);
+}
+
+// ======
+// MAIN =
+// ======
+
+int
+main(int argc,
+     char** argv)
+{
+    unsigned reps = 200;
+
+    for (int arg = 1;
+         arg < argc;
+         ++arg) {
+        if (strcmp(argv[arg], "--reps") == 0 && arg + 1 < argc) {
+            reps = strtoul(argv[++arg], NULL, 10);
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--reps N]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    // Fixed start, so that runs display the same time
+    host_set_time(1700000000,
+                  0);
+    setenv("LIVEDIGITS_HOST_12H",
+           "1",
+           1);
+    MainWindow* window = main_window_create();
+    cfg_init((config_callback_t) main_window_update_settings,
+             window);
+    window_stack_push(window,
+                      true);
+    host_send_app_message(setup_keys,
+                          setup_values,
+                          ARRAY_COUNT(setup_keys));
+
+    for (unsigned index = 0;
+         index < ARRAY_COUNT(settings);
+         ++index) {
+        bench_setting(&settings[index],
+                      reps);
+    }
+
+    main_window_destroy(window);
+    cfg_clear();
+    return 0;
+}
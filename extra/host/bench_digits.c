@@ -0,0 +1,288 @@
+/** @file
+ * Digit transition benchmark.
+ *
+ * Drive a DigitLayer through every from/to pair, for each digit size,
+ * animation speed and quick-wrap setting, and report for each transition:
+ * - the number of animation clock wakeups before the layer settle
+ * - the time (in ms) taken by the animation
+ * - the number of frames actually rendered
+ * - the average number of bitmap blits per frame
+ * - the average number of pixels written per frame
+ * - the average time spent rendering the layer per frame
+ *
+ * The output is one line per transition, followed by one summary line per
+ * configuration, so two runs can be compared with diff.
+ *
+ * With --late MS, every wakeup happens MS milliseconds after the requested
+ * deadline, like a busy watch would; late frames are dropped, so the time to
+ * settle should not grow by more than MS.
+ *
+ * --steps N sets the number of frames of each animation step (default: 9).
+ *
+ * Usage: bench-digits [--summary] [--reps N] [--late MS] [--steps N]
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+#include "digits/digit_anim.h"
+#include "digits/digit_info.h"
+#include "digits/digitlayer.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Measures for one transition */
+typedef struct {
+    unsigned wakeups;
+    unsigned duration_ms;
+    unsigned frames;
+    unsigned long blits;
+    unsigned long pixels;
+    double render_ns;
+    bool settled;
+} transition_result_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Give up on a transition after this many wakeups */
+static
+const unsigned max_wakeups = 1000;
+
+static
+const char* const size_names[DIGITS_SIZE_COUNT] = {
+    "big", "medium", "small"
+};
+
+static
+const char* const speed_names[] = {
+    "SLOW_SEPARATE", "SLOW_MERGED", "FAST_SEPARATE", "FAST_MERGED"
+};
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Measure a single transition */
+static
+transition_result_t
+run_transition(digit_size_t size,
+               animation_speed_t speed,
+               bool quick_wrap,
+               unsigned from,
+               unsigned to,
+               unsigned reps,
+               unsigned late_ms,
+               unsigned step_count);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+transition_result_t
+run_transition(digit_size_t size,
+               animation_speed_t speed,
+               bool quick_wrap,
+               unsigned from,
+               unsigned to,
+               unsigned reps,
+               unsigned late_ms,
+               unsigned step_count)
+{
+    transition_result_t result = {0, 0, 0, 0, 0, 0, false};
+    DigitLayer* layer = digit_layer_create(size,
+                                           GPointZero);
+    digit_layer_set_animate_speed(layer,
+                                  speed);
+    digit_layer_set_quick_wrap(layer,
+                               quick_wrap);
+    digit_layer_set_step_count(layer,
+                               step_count);
+    digit_layer_set_number(layer,
+                           from,
+                           false);
+    digit_layer_kill_anim(layer);
+    host_render_layer(layer);
+
+    digit_layer_set_number(layer,
+                           to,
+                           true);
+
+    // The first call only sets the deadline of the first frame
+    time_ms_t start_ms = 0;
+    time_ms_t now = start_ms;
+    time_ms_t next_frame = TIME_MS_NEVER;
+    digit_layer_animate(layer,
+                        now,
+                        &next_frame);
+
+    while (next_frame != TIME_MS_NEVER && result.wakeups < max_wakeups) {
+        unsigned long dirty_before = host_get_stats()->dirty_marks;
+        now = next_frame + late_ms;
+        next_frame = TIME_MS_NEVER;
+        digit_layer_animate(layer,
+                            now,
+                            &next_frame);
+        ++result.wakeups;
+        result.duration_ms = (unsigned)(now - start_ms);
+
+        if (host_get_stats()->dirty_marks != dirty_before) {
+            host_stats_t before = *host_get_stats();
+            host_render_layer(layer);
+            const host_stats_t* after = host_get_stats();
+            ++result.frames;
+            result.blits += after->bitmap_blits - before.bitmap_blits;
+            result.pixels += after->pixels_written - before.pixels_written;
+
+            double start = host_now_ns();
+
+            for (unsigned rep = 0;
+                 rep < reps;
+                 ++rep) {
+                host_render_layer(layer);
+            }
+
+            result.render_ns += (host_now_ns() - start) / reps;
+        }
+    }
+
+    result.settled = next_frame == TIME_MS_NEVER;
+
+    digit_layer_destroy(layer);
+    return result;
+}
+
+// ======
+// MAIN =
+// ======
+
+int
+main(int argc,
+     char** argv)
+{
+    bool summary_only = false;
+    unsigned reps = 20;
+    unsigned late_ms = 0;
+    unsigned step_count = ANIM_KEYFRAME_COUNT;
+
+    for (int arg = 1;
+         arg < argc;
+         ++arg) {
+        if (strcmp(argv[arg], "--summary") == 0) {
+            summary_only = true;
+        } else if (strcmp(argv[arg], "--reps") == 0 && arg + 1 < argc) {
+            reps = strtoul(argv[++arg], NULL, 10);
+            reps = reps ? reps : 1;
+        } else if (strcmp(argv[arg], "--late") == 0 && arg + 1 < argc) {
+            late_ms = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "--steps") == 0 && arg + 1 < argc) {
+            step_count = strtoul(argv[++arg], NULL, 10);
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--summary] [--reps N] [--late MS] "
+                    "[--steps N]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (!summary_only) {
+        printf("# size speed wrap from to wakeups ms frames blits/frame "
+               "pixels/frame ns/frame\n");
+    }
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        for (int speed = SLOW_SEPARATE;
+             speed <= FAST_MERGED;
+             ++speed) {
+            for (int quick_wrap = 0;
+                 quick_wrap < 2;
+                 ++quick_wrap) {
+                unsigned total_wakeups = 0;
+                unsigned long total_ms = 0;
+                unsigned worst_ms = 0;
+                unsigned long total_frames = 0;
+                unsigned long total_blits = 0;
+                unsigned long total_pixels = 0;
+                double total_ns = 0;
+                unsigned unsettled = 0;
+
+                for (unsigned from = 0;
+                     from < 10;
+                     ++from) {
+                    for (unsigned to = 0;
+                         to < 10;
+                         ++to) {
+                        transition_result_t result =
+                            run_transition(size,
+                                           speed,
+                                           quick_wrap,
+                                           from,
+                                           to,
+                                           reps,
+                                           late_ms,
+                                           step_count);
+                        unsigned frames = result.frames ? result.frames : 1;
+
+                        if (!summary_only) {
+                            printf("%s %s %s %u %u %u%s %u %u %.2f %.1f "
+                                   "%.0f\n",
+                                   size_names[size],
+                                   speed_names[speed],
+                                   quick_wrap ? "wrap" : "nowrap",
+                                   from,
+                                   to,
+                                   result.wakeups,
+                                   result.settled ? "" : "!",
+                                   result.duration_ms,
+                                   result.frames,
+                                   (double) result.blits / frames,
+                                   (double) result.pixels / frames,
+                                   result.render_ns / frames);
+                        }
+
+                        total_wakeups += result.wakeups;
+                        total_ms += result.duration_ms;
+                        total_frames += result.frames;
+                        total_blits += result.blits;
+                        total_pixels += result.pixels;
+                        total_ns += result.render_ns;
+                        unsettled += result.settled ? 0 : 1;
+
+                        if (result.duration_ms > worst_ms) {
+                            worst_ms = result.duration_ms;
+                        }
+                    }
+                }
+
+                unsigned long frames = total_frames ? total_frames : 1;
+                printf("# summary %s %s %s: mean wakeups %.2f, mean ms %.0f, "
+                       "worst ms %u, frames %lu, blits/frame %.2f, "
+                       "pixels/frame %.1f, "
+                       "ns/frame %.0f, unsettled %u\n",
+                       size_names[size],
+                       speed_names[speed],
+                       quick_wrap ? "wrap" : "nowrap",
+                       total_wakeups / 100.0,
+                       total_ms / 100.0,
+                       worst_ms,
+                       total_frames,
+                       (double) total_blits / frames,
+                       (double) total_pixels / frames,
+                       total_ns / frames,
+                       unsettled);
+            }
+        }
+    }
+
+    return 0;
+}
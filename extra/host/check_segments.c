@@ -0,0 +1,290 @@
+/** @file
+ * Golden-image check of the procedural segments.
+ *
+ * Compare the segment images generated by segment_raster with the segment
+ * image resources they replace, for every digit size and orientation. The
+ * generated shapes are not pixel-exact copies of the hand-drawn images, so
+ * each orientation may differ by at most one pixel out of six (counting the
+ * white pixels of the resource image); the tool exits with a non-zero status
+ * otherwise.
+ *
+ * When span tables are built in, the spans of each orientation must also match
+ * the resource image exactly.
+ *
+ * It also reports the time needed to decode all the images against the time
+ * needed to generate them, and the size of the resource files.
+ *
+ * Usage: check-segments [--verbose]
+ *
+ * With --verbose, both images are printed side by side for each orientation.
+ * Must be run from the repository root (or with LIVEDIGITS_HOST_RESOURCES set).
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <sys/stat.h>
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+#include "utils.h"
+#include "digits/digit_images.h"
+#include "digits/digit_info.h"
+#include "digits/segment_raster.h"
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Resource file prefix for each digit size */
+static
+const char* const size_prefixes[DIGITS_SIZE_COUNT] = {
+    "big", "med", "small"
+};
+
+/** At most 1 / tolerance_ratio of the pixels may differ */
+static
+const unsigned tolerance_ratio = 6;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Build the path of a segment image resource */
+static
+void
+get_image_path(digit_size_t size,
+               segment_orientation_t orientation,
+               char* path,
+               size_t path_size);
+
+/** Return a pixel of a bitmap */
+static
+bool
+get_pixel(const GBitmap* bitmap,
+          int x,
+          int y);
+
+/** Draw spans in a new bitmap */
+static
+GBitmap*
+create_from_spans(const segment_spans_t* spans,
+                  GSize bitmap_size);
+
+/** Print two bitmaps side by side */
+static
+void
+print_bitmaps(const GBitmap* expected,
+              const GBitmap* actual);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+get_image_path(digit_size_t size,
+               segment_orientation_t orientation,
+               char* path,
+               size_t path_size)
+{
+    const char* resources_dir = getenv("LIVEDIGITS_HOST_RESOURCES");
+    resources_dir = resources_dir ? resources_dir : "resources";
+
+    if (orientation == SO_VERTICAL) {
+        snprintf(path, path_size, "%s/images/%s_vert.png",
+                 resources_dir, size_prefixes[size]);
+    } else if (orientation == SO_HORIZONTAL) {
+        snprintf(path, path_size, "%s/images/%s_horiz.png",
+                 resources_dir, size_prefixes[size]);
+    } else {
+        // Numbered images skip the vertical and horizontal orientations
+        unsigned index = orientation < SO_HORIZONTAL
+                         ? orientation - 1
+                         : orientation - 2;
+        snprintf(path, path_size, "%s/images/%s%u.png",
+                 resources_dir, size_prefixes[size], index);
+    }
+}
+
+static
+bool
+get_pixel(const GBitmap* bitmap,
+          int x,
+          int y)
+{
+    const uint8_t* row = (const uint8_t*) bitmap->addr +
+                         y * bitmap->row_size_bytes;
+    return (row[x >> 3] >> (x & 7)) & 1;
+}
+
+static
+GBitmap*
+create_from_spans(const segment_spans_t* spans,
+                  GSize bitmap_size)
+{
+    GBitmap* result = gbitmap_create_blank(bitmap_size);
+
+    for (unsigned i = 0;
+         i < spans->count;
+         ++i) {
+        bitmap_fill_rect(result,
+                         GRect(segment_span_get_x(spans,
+                                                  &spans->spans[i]),
+                               spans->spans[i].y,
+                               spans->spans[i].length,
+                               1));
+    }
+
+    return result;
+}
+
+static
+void
+print_bitmaps(const GBitmap* expected,
+              const GBitmap* actual)
+{
+    for (int y = 0;
+         y < expected->bounds.size.h;
+         ++y) {
+        for (int x = 0;
+             x < expected->bounds.size.w;
+             ++x) {
+            putchar(get_pixel(expected, x, y) ? '#' : '.');
+        }
+
+        printf("   ");
+
+        for (int x = 0;
+             x < expected->bounds.size.w;
+             ++x) {
+            bool expected_pixel = get_pixel(expected, x, y);
+            bool actual_pixel = get_pixel(actual, x, y);
+            putchar(expected_pixel == actual_pixel
+                    ? (actual_pixel ? '#' : '.')
+                    : (actual_pixel ? '+' : '-'));
+        }
+
+        putchar('\n');
+    }
+}
+
+// ======
+// MAIN =
+// ======
+
+int
+main(int argc,
+     char** argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "--verbose") == 0;
+    unsigned failures = 0;
+    unsigned long total_mismatches = 0;
+    unsigned long files_size = 0;
+    double decode_ns = 0;
+    double generate_ns = 0;
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        segment_load_images(size);
+
+        for (int orientation = 0;
+             orientation < SEGMENTS_ORIENTATION_COUNT;
+             ++orientation) {
+            char path[4096];
+            get_image_path(size,
+                           orientation,
+                           path,
+                           sizeof(path));
+            struct stat file_stat;
+
+            if (stat(path, &file_stat) == 0) {
+                files_size += file_stat.st_size;
+            }
+
+            double start = host_now_ns();
+            GBitmap* expected = host_load_png(path);
+            decode_ns += host_now_ns() - start;
+
+            if (!expected) {
+                ++failures;
+                continue;
+            }
+
+            GSize bitmap_size = segment_get_size(size,
+                                                 orientation);
+            start = host_now_ns();
+            GBitmap* actual = segment_raster_create(size,
+                                                    orientation,
+                                                    bitmap_size);
+            generate_ns += host_now_ns() - start;
+
+            const segment_spans_t* spans = segment_get_spans(size,
+                                                             orientation);
+            GBitmap* from_spans = spans
+                                  ? create_from_spans(spans,
+                                                      bitmap_size)
+                                  : NULL;
+            unsigned mismatches = 0;
+            unsigned spans_mismatches = 0;
+            unsigned white_pixels = 0;
+
+            for (int y = 0;
+                 y < bitmap_size.h;
+                 ++y) {
+                for (int x = 0;
+                     x < bitmap_size.w;
+                     ++x) {
+                    white_pixels += get_pixel(expected, x, y);
+                    mismatches += get_pixel(expected, x, y) !=
+                                  get_pixel(actual, x, y);
+
+                    if (from_spans) {
+                        spans_mismatches += get_pixel(expected, x, y) !=
+                                            get_pixel(from_spans, x, y);
+                    }
+                }
+            }
+
+            bool passed =
+                expected->bounds.size.w == bitmap_size.w &&
+                expected->bounds.size.h == bitmap_size.h &&
+                mismatches * tolerance_ratio <= white_pixels &&
+                spans_mismatches == 0;
+            printf("%s %s: %u/%u pixels differ, %u in spans\n",
+                   passed ? "ok  " : "FAIL",
+                   path,
+                   mismatches,
+                   white_pixels,
+                   spans_mismatches);
+
+            if (verbose) {
+                print_bitmaps(expected,
+                              actual);
+            }
+
+            failures += passed ? 0 : 1;
+            total_mismatches += mismatches;
+            gbitmap_destroy(expected);
+            heap_gbitmap_destroy(HEAP_SEGMENTS,
+                                 actual);
+
+            if (from_spans) {
+                gbitmap_destroy(from_spans);
+            }
+        }
+
+        segment_unload_images(size);
+    }
+
+    printf("# %lu pixels differ, %u failures\n",
+           total_mismatches,
+           failures);
+    printf("# resource files: %lu bytes, decode %.0f us, generate %.0f us\n",
+           files_size,
+           decode_ns / 1000,
+           generate_ns / 1000);
+    return failures ? 1 : 0;
+}
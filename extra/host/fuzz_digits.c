@@ -0,0 +1,711 @@
+/** @file
+ * Digit state fuzzer.
+ *
+ * Drive a DigitLayer with random call sequences: set_number() (animated or
+ * not, with numbers above 9), kill_anim(), speed, quick-wrap and step count
+ * changes, and waits during which the animation runs, with wakeups up to
+ * 150ms late. After each sequence the layer is left alone until it settles,
+ * and the tool checks that:
+ * - the animation ends, within a bounded number of clock wakeups: the worst
+ *   transition between two static digits with the final settings, plus two
+ *   animation steps to get out of the step the digit was in
+ * - the displayed digit is the last requested number, pixel for pixel
+ *
+ * For each speed, the tool reports the worst number of wakeups and frames
+ * needed to settle, with the sequence that produced it. Failing sequences are
+ * printed as well, and make the tool exit with a non-zero status.
+ *
+ * Before the sequences, the quick wrap routes, whose shortcuts are only
+ * defined in extra/routes/makeroutes.py, are checked against the behaviour of
+ * digit_layer_set_quick_wrap(): for every speed, step count and pair of
+ * digits, the transition with quick wrap must not last longer than without,
+ * and going down to 0 from 2 to 8 must be shorter.
+ *
+ * Each sequence is generated from its own seed (the base seed plus the
+ * sequence index); a reported sequence can be replayed alone with
+ * --seed SEED --runs 1.
+ *
+ * Usage: fuzz-digits [--seed N] [--runs N] [--length N] [--verbose]
+ *
+ * Must be run from the repository root (or with LIVEDIGITS_HOST_RESOURCES set).
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+#include "utils.h"
+#include "digits/digit_anim.h"
+#include "digits/digit_info.h"
+#include "digits/digitlayer.h"
+
+// ========
+// CONSTS =
+// ========
+
+/** Maximum number of calls in a sequence */
+#define MAX_SEQUENCE_LENGTH 64
+
+/** Step counts are drawn in [2, MAX_STEP_COUNT] */
+#define MAX_STEP_COUNT 20
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Kind of call in a sequence */
+typedef enum {
+    OP_SET_NUMBER,
+    OP_KILL_ANIM,
+    OP_SET_SPEED,
+    OP_SET_QUICK_WRAP,
+    OP_SET_STEP_COUNT,
+    /** Let the animation run for a while */
+    OP_WAIT,
+    OP_COUNT
+} op_kind_t;
+
+/** A call in a sequence */
+typedef struct {
+    op_kind_t kind;
+    /** Number, speed, quick-wrap flag, step count or wait duration (ms) */
+    unsigned value;
+    /** Animate flag for OP_SET_NUMBER, wakeup lateness (ms) for OP_WAIT */
+    unsigned extra;
+} op_t;
+
+/** A generated sequence and the settings it ends with */
+typedef struct {
+    uint32_t seed;
+    digit_size_t size;
+    /** Number displayed when the layer is created */
+    unsigned initial_number;
+    op_t ops[MAX_SEQUENCE_LENGTH];
+    unsigned ops_count;
+    unsigned target_number;
+    animation_speed_t speed;
+    bool quick_wrap;
+    unsigned step_count;
+} sequence_t;
+
+/** Outcome of a sequence, measured from its last call */
+typedef struct {
+    unsigned wakeups;
+    unsigned frames;
+    unsigned duration_ms;
+    bool settled;
+    bool correct_digit;
+} sequence_result_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Give up on a sequence after this many wakeups */
+static
+const unsigned max_wakeups = 1000;
+
+/** Waits are drawn in [0, max_wait_ms] */
+static
+const unsigned max_wait_ms = 2000;
+
+/** Wakeup lateness is drawn in [0, max_late_ms] */
+static
+const unsigned max_late_ms = 150;
+
+static
+const char* const speed_names[] = {
+    "SLOW_SEPARATE", "SLOW_MERGED", "FAST_SEPARATE", "FAST_MERGED"
+};
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+/** State of the random generator */
+static
+uint32_t random_state;
+
+/** Worst transition between two static digits, in wakeups, per speed,
+ * quick-wrap flag and step count (0 if not measured yet) */
+static
+unsigned transition_wakeups[FAST_MERGED + 1][2][MAX_STEP_COUNT + 1];
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Return a random number in [0, bound) */
+static
+unsigned
+random_below(unsigned bound);
+
+/** Fill a sequence with random calls */
+static
+void
+generate_sequence(sequence_t* sequence,
+                  uint32_t seed,
+                  unsigned length);
+
+/** Play a sequence on a new layer and let it settle */
+static
+sequence_result_t
+run_sequence(sequence_t* sequence);
+
+/** Run the animation of a layer until it settles (or max_wakeups)
+ *
+ * @param now Current time, updated to the time the layer settled
+ * @param next_frame Deadline of the next frame
+ */
+static
+void
+settle_layer(DigitLayer* layer,
+             time_ms_t* now,
+             time_ms_t* next_frame,
+             sequence_result_t* result);
+
+/** Return true if a layer looks like a static digit */
+static
+bool
+displays_number(DigitLayer* layer,
+                digit_size_t size,
+                unsigned number);
+
+/** Animate a layer from a static digit to another and let it settle */
+static
+sequence_result_t
+measure_transition(digit_size_t size,
+                   animation_speed_t speed,
+                   bool quick_wrap,
+                   unsigned step_count,
+                   unsigned from,
+                   unsigned to);
+
+/** Return the wakeup bound of a sequence ending with the given settings.
+ *
+ * The worst transition between static digits is measured on the first call
+ * for each settings; it does not depend on the digit size.
+ */
+static
+unsigned
+get_wakeup_bound(digit_size_t size,
+                 animation_speed_t speed,
+                 bool quick_wrap,
+                 unsigned step_count);
+
+/** Check the quick wrap transitions against counting ones.
+ *
+ * @return The number of transitions that failed
+ */
+static
+unsigned
+check_quick_wrap(void);
+
+/** Print a sequence and its outcome */
+static
+void
+print_sequence(const char* title,
+               const sequence_t* sequence,
+               const sequence_result_t* result);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+unsigned
+random_below(unsigned bound)
+{
+    // xorshift32, so sequences are the same on every host
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % bound;
+}
+
+static
+void
+generate_sequence(sequence_t* sequence,
+                  uint32_t seed,
+                  unsigned length)
+{
+    random_state = seed ? seed : 1;
+    sequence->seed = seed;
+    sequence->size = random_below(DIGITS_SIZE_COUNT);
+    sequence->initial_number = random_below(10);
+    sequence->ops_count = length;
+
+    for (unsigned index = 0;
+         index < length;
+         ++index) {
+        op_t* op = &sequence->ops[index];
+        op->kind = random_below(OP_COUNT);
+        op->extra = 0;
+
+        switch (op->kind) {
+        case OP_SET_NUMBER:
+            op->value = random_below(20);
+            op->extra = random_below(4) != 0;
+            break;
+        case OP_KILL_ANIM:
+            op->value = 0;
+            break;
+        case OP_SET_SPEED:
+            op->value = random_below(FAST_MERGED + 1);
+            break;
+        case OP_SET_QUICK_WRAP:
+            op->value = random_below(2);
+            break;
+        case OP_SET_STEP_COUNT:
+            op->value = 2 + random_below(MAX_STEP_COUNT - 1);
+            break;
+        case OP_WAIT:
+        default:
+            op->value = random_below(max_wait_ms + 1);
+            op->extra = random_below(2) ? random_below(max_late_ms + 1) : 0;
+            break;
+        }
+    }
+}
+
+static
+sequence_result_t
+run_sequence(sequence_t* sequence)
+{
+    sequence_result_t result = {0, 0, 0, false, false};
+    DigitLayer* layer = digit_layer_create(sequence->size,
+                                           GPointZero);
+    digit_layer_set_number(layer,
+                           sequence->initial_number,
+                           false);
+    sequence->target_number = sequence->initial_number;
+    sequence->speed = FAST_MERGED;
+    sequence->quick_wrap = false;
+    sequence->step_count = ANIM_KEYFRAME_COUNT;
+    digit_layer_set_animate_speed(layer,
+                                  sequence->speed);
+
+    time_ms_t now = 0;
+    time_ms_t next_frame = TIME_MS_NEVER;
+
+    for (unsigned index = 0;
+         index < sequence->ops_count;
+         ++index) {
+        const op_t* op = &sequence->ops[index];
+
+        switch (op->kind) {
+        case OP_SET_NUMBER:
+            digit_layer_set_number(layer,
+                                   op->value,
+                                   op->extra);
+            sequence->target_number = op->value % 10;
+            break;
+        case OP_KILL_ANIM:
+            digit_layer_kill_anim(layer);
+            break;
+        case OP_SET_SPEED:
+            digit_layer_set_animate_speed(layer,
+                                          op->value);
+            sequence->speed = op->value;
+            break;
+        case OP_SET_QUICK_WRAP:
+            digit_layer_set_quick_wrap(layer,
+                                       op->value);
+            sequence->quick_wrap = op->value;
+            break;
+        case OP_SET_STEP_COUNT:
+            digit_layer_set_step_count(layer,
+                                       op->value);
+            sequence->step_count = op->value;
+            break;
+        case OP_WAIT:
+        default: {
+            time_ms_t end = now + op->value;
+
+            while (next_frame != TIME_MS_NEVER &&
+                   next_frame + op->extra <= end) {
+                now = next_frame + op->extra;
+                next_frame = TIME_MS_NEVER;
+                digit_layer_animate(layer,
+                                    now,
+                                    &next_frame);
+            }
+
+            now = end;
+            break;
+        }
+        }
+
+        // Like the watchface, animate after every call to get the deadline
+        // of the next frame
+        next_frame = TIME_MS_NEVER;
+        digit_layer_animate(layer,
+                            now,
+                            &next_frame);
+    }
+
+    settle_layer(layer,
+                 &now,
+                 &next_frame,
+                 &result);
+    result.correct_digit = result.settled &&
+                           displays_number(layer,
+                                           sequence->size,
+                                           sequence->target_number);
+    digit_layer_destroy(layer);
+    return result;
+}
+
+static
+void
+settle_layer(DigitLayer* layer,
+             time_ms_t* now,
+             time_ms_t* next_frame,
+             sequence_result_t* result)
+{
+    time_ms_t start_ms = *now;
+
+    while (*next_frame != TIME_MS_NEVER && result->wakeups < max_wakeups) {
+        unsigned long dirty_before = host_get_stats()->dirty_marks;
+        *now = *next_frame;
+        *next_frame = TIME_MS_NEVER;
+        digit_layer_animate(layer,
+                            *now,
+                            next_frame);
+        ++result->wakeups;
+        result->duration_ms = (unsigned)(*now - start_ms);
+
+        if (host_get_stats()->dirty_marks != dirty_before) {
+            ++result->frames;
+        }
+    }
+
+    result->settled = *next_frame == TIME_MS_NEVER;
+}
+
+static
+bool
+displays_number(DigitLayer* layer,
+                digit_size_t size,
+                unsigned number)
+{
+    GBitmap* framebuffer = host_get_framebuffer();
+    size_t framebuffer_size = framebuffer->row_size_bytes *
+                              host_screen_height;
+    uint8_t* actual = malloc(framebuffer_size);
+
+    host_render_layer(layer);
+    memcpy(actual,
+           framebuffer->addr,
+           framebuffer_size);
+
+    DigitLayer* reference = digit_layer_create(size,
+                                               GPointZero);
+    digit_layer_set_number(reference,
+                           number,
+                           false);
+    host_render_layer(reference);
+    digit_layer_destroy(reference);
+
+    bool result = memcmp(actual,
+                         framebuffer->addr,
+                         framebuffer_size) == 0;
+    free(actual);
+    return result;
+}
+
+static
+sequence_result_t
+measure_transition(digit_size_t size,
+                   animation_speed_t speed,
+                   bool quick_wrap,
+                   unsigned step_count,
+                   unsigned from,
+                   unsigned to)
+{
+    sequence_result_t result = {0, 0, 0, false, false};
+    DigitLayer* layer = digit_layer_create(size,
+                                           GPointZero);
+    digit_layer_set_animate_speed(layer,
+                                  speed);
+    digit_layer_set_quick_wrap(layer,
+                               quick_wrap);
+    digit_layer_set_step_count(layer,
+                               step_count);
+    digit_layer_set_number(layer,
+                           from,
+                           false);
+    digit_layer_set_number(layer,
+                           to,
+                           true);
+
+    time_ms_t now = 0;
+    time_ms_t next_frame = TIME_MS_NEVER;
+    digit_layer_animate(layer,
+                        now,
+                        &next_frame);
+    settle_layer(layer,
+                 &now,
+                 &next_frame,
+                 &result);
+    digit_layer_destroy(layer);
+    return result;
+}
+
+static
+unsigned
+get_wakeup_bound(digit_size_t size,
+                 animation_speed_t speed,
+                 bool quick_wrap,
+                 unsigned step_count)
+{
+    unsigned* worst = &transition_wakeups[speed][quick_wrap][step_count];
+
+    if (*worst == 0) {
+        for (unsigned from = 0;
+             from < 10;
+             ++from) {
+            for (unsigned to = 0;
+                 to < 10;
+                 ++to) {
+                sequence_result_t result = measure_transition(size,
+                                                              speed,
+                                                              quick_wrap,
+                                                              step_count,
+                                                              from,
+                                                              to);
+
+                if (result.wakeups > *worst) {
+                    *worst = result.wakeups;
+                }
+            }
+        }
+    }
+
+    return *worst + 2 * step_count;
+}
+
+static
+unsigned
+check_quick_wrap(void)
+{
+    unsigned checked = 0;
+    unsigned failures = 0;
+
+    for (int speed = SLOW_SEPARATE;
+         speed <= FAST_MERGED;
+         ++speed) {
+        for (unsigned step_count = 2;
+             step_count <= MAX_STEP_COUNT;
+             ++step_count) {
+            for (unsigned from = 0;
+                 from < 10;
+                 ++from) {
+                for (unsigned to = 0;
+                     to < 10;
+                     ++to) {
+                    sequence_result_t counting =
+                        measure_transition(DS_SMALL,
+                                           speed,
+                                           false,
+                                           step_count,
+                                           from,
+                                           to);
+                    sequence_result_t quick =
+                        measure_transition(DS_SMALL,
+                                           speed,
+                                           true,
+                                           step_count,
+                                           from,
+                                           to);
+                    // The shortcut of 1 is as long as counting down, and 9
+                    // counts to 0 anyway
+                    bool shortcut = to == 0 && from >= 2 && from <= 8;
+                    ++checked;
+
+                    if (quick.duration_ms > counting.duration_ms ||
+                        (shortcut &&
+                         quick.duration_ms == counting.duration_ms)) {
+                        printf("FAILED quick wrap %u to %u: %s, %u frames "
+                               "per step, %u ms instead of %u ms\n",
+                               from,
+                               to,
+                               speed_names[speed],
+                               step_count,
+                               quick.duration_ms,
+                               counting.duration_ms);
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("# quick wrap: %u transitions, %u failed\n",
+           checked,
+           failures);
+    return failures;
+}
+
+static
+void
+print_sequence(const char* title,
+               const sequence_t* sequence,
+               const sequence_result_t* result)
+{
+    printf("%s: seed %u, %u wakeups, %u frames, %u ms%s%s\n",
+           title,
+           sequence->seed,
+           result->wakeups,
+           result->frames,
+           result->duration_ms,
+           result->settled ? "" : ", unsettled",
+           result->correct_digit ? "" : ", wrong digit");
+    printf("    size %u, start at %u\n",
+           sequence->size,
+           sequence->initial_number);
+
+    for (unsigned index = 0;
+         index < sequence->ops_count;
+         ++index) {
+        const op_t* op = &sequence->ops[index];
+
+        switch (op->kind) {
+        case OP_SET_NUMBER:
+            printf("    set_number %u%s\n",
+                   op->value,
+                   op->extra ? " animated" : "");
+            break;
+        case OP_KILL_ANIM:
+            printf("    kill_anim\n");
+            break;
+        case OP_SET_SPEED:
+            printf("    set_animate_speed %s\n",
+                   speed_names[op->value]);
+            break;
+        case OP_SET_QUICK_WRAP:
+            printf("    set_quick_wrap %s\n",
+                   op->value ? "true" : "false");
+            break;
+        case OP_SET_STEP_COUNT:
+            printf("    set_step_count %u\n",
+                   op->value);
+            break;
+        case OP_WAIT:
+        default:
+            printf("    wait %u ms (%u ms late)\n",
+                   op->value,
+                   op->extra);
+            break;
+        }
+    }
+
+    printf("    then settle to %u: %s, quick wrap %s, %u frames per step\n",
+           sequence->target_number,
+           speed_names[sequence->speed],
+           sequence->quick_wrap ? "on" : "off",
+           sequence->step_count);
+}
+
+// ======
+// MAIN =
+// ======
+
+int
+main(int argc,
+     char** argv)
+{
+    uint32_t seed = 1;
+    unsigned runs = 10000;
+    unsigned length = 12;
+    bool verbose = false;
+
+    for (int arg = 1;
+         arg < argc;
+         ++arg) {
+        if (strcmp(argv[arg], "--seed") == 0 && arg + 1 < argc) {
+            seed = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "--runs") == 0 && arg + 1 < argc) {
+            runs = strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "--length") == 0 && arg + 1 < argc) {
+            length = strtoul(argv[++arg], NULL, 10);
+            length = length > MAX_SEQUENCE_LENGTH
+                     ? MAX_SEQUENCE_LENGTH
+                     : length;
+        } else if (strcmp(argv[arg], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--seed N] [--runs N] [--length N] "
+                    "[--verbose]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    sequence_t worst_sequences[FAST_MERGED + 1];
+    sequence_result_t worst_results[FAST_MERGED + 1];
+    bool has_worst[FAST_MERGED + 1] = {false};
+    unsigned quick_wrap_failures = check_quick_wrap();
+    unsigned failures = 0;
+
+    for (unsigned run = 0;
+         run < runs;
+         ++run) {
+        sequence_t sequence;
+        generate_sequence(&sequence,
+                          seed + run,
+                          length);
+        sequence_result_t result = run_sequence(&sequence);
+        unsigned bound = get_wakeup_bound(sequence.size,
+                                          sequence.speed,
+                                          sequence.quick_wrap,
+                                          sequence.step_count);
+
+        if (!result.settled || !result.correct_digit ||
+            result.wakeups > bound) {
+            char title[64];
+            snprintf(title, sizeof(title),
+                     "FAILED (bound %u wakeups)",
+                     bound);
+            print_sequence(title,
+                           &sequence,
+                           &result);
+            ++failures;
+        } else if (verbose) {
+            print_sequence("sequence",
+                           &sequence,
+                           &result);
+        }
+
+        if (!has_worst[sequence.speed] ||
+            result.wakeups > worst_results[sequence.speed].wakeups) {
+            worst_sequences[sequence.speed] = sequence;
+            worst_results[sequence.speed] = result;
+            has_worst[sequence.speed] = true;
+        }
+    }
+
+    for (int speed = SLOW_SEPARATE;
+         speed <= FAST_MERGED;
+         ++speed) {
+        if (!has_worst[speed]) {
+            continue;
+        }
+
+        char title[64];
+        snprintf(title, sizeof(title),
+                 "# worst %s",
+                 speed_names[speed]);
+        print_sequence(title,
+                       &worst_sequences[speed],
+                       &worst_results[speed]);
+    }
+
+    printf("# %u sequences, %u failed\n",
+           runs,
+           failures);
+    return failures || quick_wrap_failures ? 1 : 0;
+}
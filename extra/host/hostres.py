@@ -0,0 +1,58 @@
+#!/usr/bin/env python
+
+"""Generate the resource table used by the host build.
+
+The watch build get its RESOURCE_ID_* values from the SDK. The host build
+read the same list from appinfo.json, and load the PNG files directly from
+the resources directory at runtime.
+"""
+
+import json
+import sys
+
+def readMedia(appInfoPath):
+    "Return the list of (name, file) of media resources, in declaration order"
+    with open(appInfoPath, 'r') as inFile:
+        appInfo = json.load(inFile)
+    return [(media['name'], media['file']) for media in appInfo['resources']['media']]
+
+def generateHeader(media, outPath):
+    "Write the RESOURCE_ID_* definitions"
+    with open(outPath, 'w') as output:
+        output.write('/* GENERATED HEADER DO NOT MODIFY */\n'
+                     '#ifndef INCL_RESOURCE_IDS_AUTO_H\n'
+                     '#define INCL_RESOURCE_IDS_AUTO_H\n'
+                     '\n'
+                     'enum {\n'
+                     'INVALID_RESOURCE = 0,\n')
+        for index, (name, _) in enumerate(media):
+            output.write('RESOURCE_ID_%s = %i,\n' % (name, index + 1))
+        output.write('};\n'
+                     '\n'
+                     '/** Resource files, relative to the resources directory */\n'
+                     'extern const char* const host_resource_files[];\n'
+                     'extern const unsigned host_resource_count;\n'
+                     '\n'
+                     '#endif\n')
+
+def generateSource(media, outPath):
+    "Write the resource file table"
+    with open(outPath, 'w') as output:
+        output.write('/* GENERATED SOURCE FILE DO NOT MODIFY */\n'
+                     '#include "resource_ids.auto.h"\n'
+                     'const char* const host_resource_files[] = {\n')
+        for _, fileName in media:
+            output.write('"%s",\n' % fileName)
+        output.write('};\n'
+                     'const unsigned host_resource_count = %i;\n' % len(media))
+
+def main(appInfoPath, headerPath, sourcePath):
+    media = readMedia(appInfoPath)
+    generateHeader(media, headerPath)
+    generateSource(media, sourcePath)
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        print('Usage: hostres.py <appinfo.json> <header output> <source output>')
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2], sys.argv[3])
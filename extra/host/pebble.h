@@ -0,0 +1,615 @@
+/** @file
+ * Host stand-in for the Pebble SDK header.
+ *
+ * This header exposes the subset of the Pebble SDK 2 API used by the watchface,
+ * so the application sources can be compiled and run on a regular Linux box.
+ * Everything is implemented in pebble_host.c on top of a 144x168 1bpp
+ * framebuffer.
+ *
+ * Only the host build use this file; the watch build keep using the SDK
+ * header. Host-specific controls (simulated clock, frame dump, counters) are
+ * declared in pebble_host.h.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_PEBBLE_HOST_STANDIN_H
+#define INCL_PEBBLE_HOST_STANDIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "resource_ids.auto.h"
+
+// ========
+// MEMORY =
+// ========
+
+/* The heap is simulated by counting the usable size of the live blocks
+ * allocated by the application and the stand-in, so heap_bytes_used() can be
+ * checked after any call. The functions are called in parentheses where the
+ * C library ones are needed.
+ */
+#define malloc(size) host_malloc(size)
+#define calloc(count, size) host_calloc(count, size)
+#define free(pointer) host_free(pointer)
+
+void*
+host_malloc(size_t size);
+
+void*
+host_calloc(size_t count,
+            size_t size);
+
+void
+host_free(void* pointer);
+
+/** Return the number of bytes allocated on the simulated heap. */
+size_t
+heap_bytes_used(void);
+
+/** Return the number of bytes left on the simulated heap. */
+size_t
+heap_bytes_free(void);
+
+// =============
+// BASIC TYPES =
+// =============
+
+typedef int32_t status_t;
+
+typedef uint32_t ResourceId;
+
+typedef struct GPoint {
+    int16_t x;
+    int16_t y;
+} GPoint;
+
+typedef struct GSize {
+    int16_t w;
+    int16_t h;
+} GSize;
+
+typedef struct GRect {
+    GPoint origin;
+    GSize size;
+} GRect;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GPointZero GPoint(0, 0)
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GSizeZero GSize(0, 0)
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GRectZero GRect(0, 0, 0, 0)
+
+typedef enum GColor {
+    GColorClear = ~0,
+    GColorBlack = 0,
+    GColorWhite = 1
+} GColor;
+
+typedef enum {
+    GCompOpAssign,
+    GCompOpAssignInverted,
+    GCompOpOr,
+    GCompOpAnd,
+    GCompOpClear,
+    GCompOpSet
+} GCompOp;
+
+typedef enum {
+    GCornerNone = 0,
+    GCornersAll = 0x0F
+} GCornerMask;
+
+typedef enum {
+    GTextOverflowModeWordWrap,
+    GTextOverflowModeTrailingEllipsis,
+    GTextOverflowModeFill
+} GTextOverflowMode;
+
+typedef enum {
+    GTextAlignmentLeft,
+    GTextAlignmentCenter,
+    GTextAlignmentRight
+} GTextAlignment;
+
+typedef void* GTextLayoutCacheRef;
+
+/** Fonts are not rasterized on the host, this is only an opaque token. */
+typedef void* GFont;
+
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+
+/** 1bpp bitmap, same layout as the SDK 2 structure.
+ *
+ * Pixels are packed LSB first, white is 1. row_size_bytes is always a multiple
+ * of 4.
+ */
+typedef struct {
+    void* addr;
+    uint16_t row_size_bytes;
+    uint16_t info_flags;
+    GRect bounds;
+} GBitmap;
+
+typedef struct GContext GContext;
+
+typedef struct Layer Layer;
+
+typedef struct Window Window;
+
+typedef struct TextLayer TextLayer;
+
+typedef struct InverterLayer InverterLayer;
+
+typedef struct AppTimer AppTimer;
+
+// ==========
+// GRAPHICS =
+// ==========
+
+void
+graphics_context_set_compositing_mode(GContext* ctx,
+                                      GCompOp mode);
+
+void
+graphics_context_set_fill_color(GContext* ctx,
+                                GColor color);
+
+void
+graphics_context_set_stroke_color(GContext* ctx,
+                                  GColor color);
+
+void
+graphics_context_set_text_color(GContext* ctx,
+                                GColor color);
+
+void
+graphics_fill_rect(GContext* ctx,
+                   GRect rect,
+                   uint16_t corner_radius,
+                   GCornerMask corner_mask);
+
+void
+graphics_draw_bitmap_in_rect(GContext* ctx,
+                             const GBitmap* bitmap,
+                             GRect rect);
+
+/** Text is not rasterized on the host; the call is only counted. */
+void
+graphics_draw_text(GContext* ctx,
+                   const char* text,
+                   const GFont font,
+                   const GRect box,
+                   const GTextOverflowMode overflow_mode,
+                   const GTextAlignment alignment,
+                   const GTextLayoutCacheRef layout);
+
+GBitmap*
+graphics_capture_frame_buffer(GContext* ctx);
+
+bool
+graphics_release_frame_buffer(GContext* ctx,
+                              GBitmap* buffer);
+
+GFont
+fonts_get_system_font(const char* font_key);
+
+// =========
+// BITMAPS =
+// =========
+
+GBitmap*
+gbitmap_create_with_resource(uint32_t resource_id);
+
+GBitmap*
+gbitmap_create_blank(GSize size);
+
+GBitmap*
+gbitmap_create_as_sub_bitmap(const GBitmap* base_bitmap,
+                             GRect sub_rect);
+
+void
+gbitmap_destroy(GBitmap* bitmap);
+
+// ========
+// LAYERS =
+// ========
+
+typedef void (*LayerUpdateProc)(struct Layer* layer,
+                                GContext* ctx);
+
+Layer*
+layer_create(GRect frame);
+
+Layer*
+layer_create_with_data(GRect frame,
+                       size_t data_size);
+
+void
+layer_destroy(Layer* layer);
+
+void*
+layer_get_data(const Layer* layer);
+
+void
+layer_set_update_proc(Layer* layer,
+                      LayerUpdateProc update_proc);
+
+void
+layer_mark_dirty(Layer* layer);
+
+void
+layer_add_child(Layer* parent,
+                Layer* child);
+
+void
+layer_remove_from_parent(Layer* child);
+
+GRect
+layer_get_frame(const Layer* layer);
+
+void
+layer_set_frame(Layer* layer,
+                GRect frame);
+
+GRect
+layer_get_bounds(const Layer* layer);
+
+void
+layer_set_bounds(Layer* layer,
+                 GRect bounds);
+
+bool
+layer_get_hidden(const Layer* layer);
+
+void
+layer_set_hidden(Layer* layer,
+                 bool hidden);
+
+void
+layer_set_clips(Layer* layer,
+                bool clips);
+
+TextLayer*
+text_layer_create(GRect frame);
+
+void
+text_layer_destroy(TextLayer* text_layer);
+
+Layer*
+text_layer_get_layer(TextLayer* text_layer);
+
+void
+text_layer_set_text(TextLayer* text_layer,
+                    const char* text);
+
+void
+text_layer_set_font(TextLayer* text_layer,
+                    GFont font);
+
+void
+text_layer_set_text_color(TextLayer* text_layer,
+                          GColor color);
+
+void
+text_layer_set_background_color(TextLayer* text_layer,
+                                GColor color);
+
+void
+text_layer_set_text_alignment(TextLayer* text_layer,
+                              GTextAlignment text_alignment);
+
+InverterLayer*
+inverter_layer_create(GRect frame);
+
+void
+inverter_layer_destroy(InverterLayer* inverter_layer);
+
+Layer*
+inverter_layer_get_layer(InverterLayer* inverter_layer);
+
+// =========
+// WINDOWS =
+// =========
+
+typedef void (*WindowHandler)(Window* window);
+
+typedef struct {
+    WindowHandler load;
+    WindowHandler appear;
+    WindowHandler disappear;
+    WindowHandler unload;
+} WindowHandlers;
+
+Window*
+window_create(void);
+
+void
+window_destroy(Window* window);
+
+void
+window_set_window_handlers(Window* window,
+                           WindowHandlers handlers);
+
+Layer*
+window_get_root_layer(const Window* window);
+
+void
+window_set_background_color(Window* window,
+                            GColor background_color);
+
+void
+window_set_user_data(Window* window,
+                     void* data);
+
+void*
+window_get_user_data(const Window* window);
+
+void
+window_stack_push(Window* window,
+                  bool animated);
+
+// ========
+// TIMERS =
+// ========
+
+typedef void (*AppTimerCallback)(void* data);
+
+AppTimer*
+app_timer_register(uint32_t timeout_ms,
+                   AppTimerCallback callback,
+                   void* callback_data);
+
+bool
+app_timer_reschedule(AppTimer* timer_handle,
+                     uint32_t new_timeout_ms);
+
+void
+app_timer_cancel(AppTimer* timer_handle);
+
+// ==========
+// SERVICES =
+// ==========
+
+typedef enum {
+    SECOND_UNIT = 1 << 0,
+    MINUTE_UNIT = 1 << 1,
+    HOUR_UNIT = 1 << 2,
+    DAY_UNIT = 1 << 3,
+    MONTH_UNIT = 1 << 4,
+    YEAR_UNIT = 1 << 5
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm* tick_time,
+                            TimeUnits units_changed);
+
+void
+tick_timer_service_subscribe(TimeUnits tick_units,
+                             TickHandler handler);
+
+void
+tick_timer_service_unsubscribe(void);
+
+typedef enum {
+    ACCEL_AXIS_X = 0,
+    ACCEL_AXIS_Y = 1,
+    ACCEL_AXIS_Z = 2
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType axis,
+                                int32_t direction);
+
+void
+accel_tap_service_subscribe(AccelTapHandler handler);
+
+void
+accel_tap_service_unsubscribe(void);
+
+typedef void (*BluetoothConnectionHandler)(bool connected);
+
+void
+bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler);
+
+void
+bluetooth_connection_service_unsubscribe(void);
+
+bool
+bluetooth_connection_service_peek(void);
+
+typedef struct {
+    uint8_t charge_percent;
+    bool is_charging;
+    bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+
+void
+battery_state_service_subscribe(BatteryStateHandler handler);
+
+void
+battery_state_service_unsubscribe(void);
+
+BatteryChargeState
+battery_state_service_peek(void);
+
+void
+vibes_short_pulse(void);
+
+void
+vibes_long_pulse(void);
+
+void
+vibes_double_pulse(void);
+
+// ======
+// MATH =
+// ======
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+
+int32_t
+sin_lookup(int32_t angle);
+
+int32_t
+cos_lookup(int32_t angle);
+
+// ======
+// TIME =
+// ======
+
+/** Simulated wall clock. See host_set_time(). */
+time_t
+host_time(time_t* tloc);
+
+#define time(tloc) host_time(tloc)
+
+uint16_t
+time_ms(time_t* tloc,
+        uint16_t* out_ms);
+
+bool
+clock_is_24h_style(void);
+
+// ============
+// WATCH INFO =
+// ============
+
+typedef enum {
+    WATCH_INFO_COLOR_UNKNOWN = 0,
+    WATCH_INFO_COLOR_BLACK = 1,
+    WATCH_INFO_COLOR_WHITE = 2,
+    WATCH_INFO_COLOR_RED = 3,
+    WATCH_INFO_COLOR_ORANGE = 4,
+    WATCH_INFO_COLOR_GREY = 5,
+    WATCH_INFO_COLOR_STAINLESS_STEEL = 6,
+    WATCH_INFO_COLOR_MATTE_BLACK = 7,
+    WATCH_INFO_COLOR_BLUE = 8,
+    WATCH_INFO_COLOR_GREEN = 9,
+    WATCH_INFO_COLOR_PINK = 10
+} WatchInfoColor;
+
+WatchInfoColor
+watch_info_get_color(void);
+
+// =========
+// PERSIST =
+// =========
+
+bool
+persist_exists(const uint32_t key);
+
+int32_t
+persist_read_int(const uint32_t key);
+
+status_t
+persist_write_int(const uint32_t key,
+                  const int32_t value);
+
+bool
+persist_read_bool(const uint32_t key);
+
+status_t
+persist_write_bool(const uint32_t key,
+                   const bool value);
+
+status_t
+persist_delete(const uint32_t key);
+
+// =============
+// APP MESSAGE =
+// =============
+
+typedef enum {
+    TUPLE_BYTE_ARRAY = 0,
+    TUPLE_CSTRING = 1,
+    TUPLE_UINT = 2,
+    TUPLE_INT = 3
+} TupleType;
+
+typedef struct {
+    uint32_t key;
+    TupleType type;
+    uint16_t length;
+    union {
+        uint8_t data[0];
+        char cstring[0];
+        uint32_t uint32;
+        int32_t int32;
+    } value[];
+} Tuple;
+
+typedef struct DictionaryIterator DictionaryIterator;
+
+typedef enum {
+    APP_MSG_OK = 0
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator* iterator,
+                                        void* context);
+
+Tuple*
+dict_read_first(DictionaryIterator* iter);
+
+Tuple*
+dict_read_next(DictionaryIterator* iter);
+
+AppMessageInboxReceived
+app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+
+void
+app_message_deregister_callbacks(void);
+
+uint32_t
+app_message_inbox_size_maximum(void);
+
+uint32_t
+app_message_outbox_size_maximum(void);
+
+AppMessageResult
+app_message_open(const uint32_t size_inbound,
+                 const uint32_t size_outbound);
+
+// =========
+// LOGGING =
+// =========
+
+typedef enum {
+    APP_LOG_LEVEL_ERROR = 1,
+    APP_LOG_LEVEL_WARNING = 50,
+    APP_LOG_LEVEL_INFO = 100,
+    APP_LOG_LEVEL_DEBUG = 200,
+    APP_LOG_LEVEL_DEBUG_VERBOSE = 255
+} AppLogLevel;
+
+void
+app_log(uint8_t log_level,
+        const char* src_filename,
+        int src_line_number,
+        const char* fmt,
+        ...);
+
+#define APP_LOG(level, fmt, args...) \
+    app_log(level, __FILE__, __LINE__, fmt, ## args)
+
+// ============
+// EVENT LOOP =
+// ============
+
+/** Run the simulated event loop. See pebble_host.h for its controls. */
+void
+app_event_loop(void);
+
+#endif
@@ -0,0 +1,1935 @@
+/** @file
+ * Implementation of the Pebble stand-in for the host build.
+ *
+ * Layers are kept in a tree like on the watch, and the whole tree of the
+ * pushed window is redrawn in the framebuffer whenever a layer is marked dirty.
+ * Time only moves when asked to (host_advance_ms()), so runs are reproducible.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdarg.h>
+#include <sys/stat.h>
+
+#include <png.h>
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+
+// The stand-in header redirect time() to the simulated clock; the
+// implementation needs the real one.
+#undef time
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Alignment for layer data */
+typedef union {
+    void* pointer;
+    long double floating;
+    uint64_t integer;
+} host_align_t;
+
+struct Layer {
+    GRect frame;
+    GRect bounds;
+    bool hidden;
+    bool clips;
+    LayerUpdateProc update_proc;
+    Layer* parent;
+    Layer* first_child;
+    Layer* next_sibling;
+    host_align_t data[];
+};
+
+struct GContext {
+    GBitmap* framebuffer;
+    /** Absolute position of the layer drawing origin */
+    GPoint offset;
+    /** Absolute clipping rectangle */
+    GRect clip;
+    GCompOp compositing_mode;
+    GColor fill_color;
+    GColor stroke_color;
+    GColor text_color;
+};
+
+struct Window {
+    Layer* root_layer;
+    WindowHandlers handlers;
+    GColor background_color;
+    void* user_data;
+    bool loaded;
+};
+
+struct AppTimer {
+    uint64_t deadline;
+    AppTimerCallback callback;
+    void* callback_data;
+    AppTimer* next;
+};
+
+struct DictionaryIterator {
+    Tuple** tuples;
+    unsigned count;
+    unsigned cursor;
+};
+
+/** TextLayer state, stored as layer data */
+typedef struct {
+    const char* text;
+    GFont font;
+    GColor text_color;
+    GColor background_color;
+    GTextAlignment alignment;
+} text_info_t;
+
+/** A persisted value */
+typedef struct {
+    uint32_t key;
+    int32_t value;
+    bool used;
+} persist_entry_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Set in GBitmap.info_flags when the bitmap owns its pixel data */
+static
+const uint16_t bitmap_owns_data = 1u << 15;
+
+/** Number of persisted keys supported */
+#define PERSIST_CAPACITY 64
+
+/** Framebuffer row size (same as the watch) */
+#define FRAMEBUFFER_ROW_SIZE 20
+
+/** Simulated heap size, the application heap of the original Pebble */
+static
+const size_t heap_size = 24 * 1024;
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+static
+uint8_t framebuffer_data[FRAMEBUFFER_ROW_SIZE * 168];
+
+static
+GBitmap framebuffer = {
+    framebuffer_data,
+    FRAMEBUFFER_ROW_SIZE,
+    0,
+    {{0, 0}, {144, 168}}
+};
+
+/** The window on top of the stack (the host only handle one) */
+static
+Window* top_window = NULL;
+
+/** Set when a layer was marked dirty */
+static
+bool need_render = true;
+
+static
+host_stats_t stats;
+
+/** Usable size of the live blocks of the simulated heap */
+static
+size_t heap_used = 0;
+
+/** Simulated wall clock, in milliseconds */
+static
+uint64_t clock_ms = 0;
+
+static
+bool clock_ready = false;
+
+/** Registered timers, sorted by deadline */
+static
+AppTimer* timers = NULL;
+
+static
+TickHandler tick_handler = NULL;
+
+static
+TimeUnits tick_units = 0;
+
+/** Last time the tick service was evaluated, in seconds */
+static
+time_t last_tick_time = 0;
+
+static
+AccelTapHandler tap_handler = NULL;
+
+static
+BluetoothConnectionHandler bt_handler = NULL;
+
+static
+bool bt_connected = true;
+
+static
+BatteryStateHandler battery_handler = NULL;
+
+static
+BatteryChargeState battery_state = {80, false, false};
+
+static
+AppMessageInboxReceived inbox_handler = NULL;
+
+/** Stand-in for the AppMessage buffers, so their size shows in the heap */
+static
+void* app_message_buffers = NULL;
+
+static
+persist_entry_t persist_entries[PERSIST_CAPACITY];
+
+static
+void (*frame_callback)(void* data) = NULL;
+
+static
+void* frame_callback_data = NULL;
+
+/** Dummy object used as the font token */
+static
+char dummy_font;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Initialize the simulated clock from the environment on first use */
+static
+void
+ensure_clock(void);
+
+/** Return the intersection of two rectangles */
+static
+GRect
+rect_intersect(GRect a,
+               GRect b);
+
+/** Read a single pixel of a bitmap (coordinates relative to its bounds) */
+static inline
+bool
+bitmap_get_pixel(const GBitmap* bitmap,
+                 int x,
+                 int y)
+{
+    x += bitmap->bounds.origin.x;
+    y += bitmap->bounds.origin.y;
+    const uint8_t* row = ((const uint8_t*) bitmap->addr) +
+                         y * bitmap->row_size_bytes;
+    return (row[x >> 3] >> (x & 7)) & 1;
+}
+
+/** Write a single pixel of the framebuffer */
+static inline
+void
+framebuffer_set_pixel(GBitmap* target,
+                      int x,
+                      int y,
+                      bool value)
+{
+    uint8_t* byte = ((uint8_t*) target->addr) +
+                    y * target->row_size_bytes + (x >> 3);
+
+    if (value) {
+        *byte |= 1u << (x & 7);
+    } else {
+        *byte &= ~(1u << (x & 7));
+    }
+}
+
+/** Read a single pixel of the framebuffer */
+static inline
+bool
+framebuffer_get_pixel(const GBitmap* target,
+                      int x,
+                      int y)
+{
+    const uint8_t* byte = ((const uint8_t*) target->addr) +
+                          y * target->row_size_bytes + (x >> 3);
+    return (*byte >> (x & 7)) & 1;
+}
+
+/** Draw a layer and its children */
+static
+void
+render_layer_tree(Layer* layer,
+                  GBitmap* target,
+                  GPoint parent_offset,
+                  GRect parent_clip);
+
+/** Fill the framebuffer with a color */
+static
+void
+clear_framebuffer(GColor color);
+
+/** Call the frame callback once a frame was rendered */
+static
+void
+frame_rendered(void);
+
+/** Insert a timer in the sorted timer list */
+static
+void
+insert_timer(AppTimer* timer);
+
+/** Remove a timer from the timer list.
+ *
+ * @return false if the timer was not registered
+ */
+static
+bool
+remove_timer(AppTimer* timer);
+
+/** Fire the tick service if the clock crossed a second boundary */
+static
+void
+dispatch_tick(void);
+
+/** Allocate a 1bpp bitmap with blank content */
+static
+GBitmap*
+bitmap_allocate(GSize size);
+
+static
+void
+text_layer_update(Layer* layer,
+                  GContext* ctx);
+
+static
+void
+inverter_layer_update(Layer* layer,
+                      GContext* ctx);
+
+static
+persist_entry_t*
+persist_find(uint32_t key,
+             bool create);
+
+/** Frame callback used by app_event_loop() to dump frames */
+static
+void
+dump_frame(const char* directory);
+
+/** Send a "KEY=VALUE,KEY=VALUE" list as a configuration message */
+static
+void
+send_config(const char* config);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+ensure_clock(void)
+{
+    if (clock_ready) {
+        return;
+    }
+
+    clock_ready = true;
+    const char* start = getenv("LIVEDIGITS_HOST_START");
+    time_t start_time = start
+                        ? (time_t) strtoll(start, NULL, 10)
+                        : time(NULL);
+    clock_ms = ((uint64_t) start_time) * 1000;
+    last_tick_time = start_time;
+}
+
+static
+GRect
+rect_intersect(GRect a,
+               GRect b)
+{
+    int left = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+    int top = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+    int a_right = a.origin.x + a.size.w;
+    int b_right = b.origin.x + b.size.w;
+    int a_bottom = a.origin.y + a.size.h;
+    int b_bottom = b.origin.y + b.size.h;
+    int right = a_right < b_right ? a_right : b_right;
+    int bottom = a_bottom < b_bottom ? a_bottom : b_bottom;
+
+    if (right <= left || bottom <= top) {
+        return GRect(left, top, 0, 0);
+    }
+
+    return GRect(left, top, right - left, bottom - top);
+}
+
+static
+void
+render_layer_tree(Layer* layer,
+                  GBitmap* target,
+                  GPoint parent_offset,
+                  GRect parent_clip)
+{
+    if (layer->hidden) {
+        return;
+    }
+
+    GRect absolute_frame = layer->frame;
+    absolute_frame.origin.x += parent_offset.x;
+    absolute_frame.origin.y += parent_offset.y;
+
+    GContext ctx;
+    ctx.framebuffer = target;
+    ctx.offset = GPoint(absolute_frame.origin.x + layer->bounds.origin.x,
+                        absolute_frame.origin.y + layer->bounds.origin.y);
+    ctx.clip = layer->clips
+               ? rect_intersect(parent_clip, absolute_frame)
+               : parent_clip;
+    ctx.compositing_mode = GCompOpAssign;
+    ctx.fill_color = GColorBlack;
+    ctx.stroke_color = GColorBlack;
+    ctx.text_color = GColorWhite;
+
+    if (layer->update_proc) {
+        ++stats.update_procs;
+        layer->update_proc(layer, &ctx);
+    }
+
+    for (Layer* child = layer->first_child;
+         child;
+         child = child->next_sibling) {
+        render_layer_tree(child,
+                          target,
+                          ctx.offset,
+                          ctx.clip);
+    }
+}
+
+static
+void
+clear_framebuffer(GColor color)
+{
+    memset(framebuffer_data,
+           (color == GColorWhite) ? 0xFF : 0x00,
+           sizeof(framebuffer_data));
+}
+
+static
+void
+frame_rendered(void)
+{
+    ++stats.frames;
+
+    if (frame_callback) {
+        frame_callback(frame_callback_data);
+    }
+}
+
+static
+void
+insert_timer(AppTimer* timer)
+{
+    // Timers with the same deadline fire in registration order
+    AppTimer** slot = &timers;
+
+    while (*slot && (*slot)->deadline <= timer->deadline) {
+        slot = &(*slot)->next;
+    }
+
+    timer->next = *slot;
+    *slot = timer;
+}
+
+static
+bool
+remove_timer(AppTimer* timer)
+{
+    AppTimer** slot = &timers;
+
+    while (*slot && *slot != timer) {
+        slot = &(*slot)->next;
+    }
+
+    if (!*slot) {
+        return false;
+    }
+
+    *slot = timer->next;
+    return true;
+}
+
+static
+void
+dispatch_tick(void)
+{
+    time_t now = (time_t)(clock_ms / 1000);
+
+    if (now == last_tick_time) {
+        return;
+    }
+
+    struct tm previous = *localtime(&last_tick_time);
+    struct tm* current = localtime(&now);
+    last_tick_time = now;
+
+    if (!tick_handler) {
+        return;
+    }
+
+    TimeUnits changed = SECOND_UNIT;
+
+    if (previous.tm_min != current->tm_min) {
+        changed |= MINUTE_UNIT;
+    }
+
+    if (previous.tm_hour != current->tm_hour) {
+        changed |= HOUR_UNIT;
+    }
+
+    if (previous.tm_mday != current->tm_mday) {
+        changed |= DAY_UNIT;
+    }
+
+    if (previous.tm_mon != current->tm_mon) {
+        changed |= MONTH_UNIT;
+    }
+
+    if (previous.tm_year != current->tm_year) {
+        changed |= YEAR_UNIT;
+    }
+
+    if (changed & tick_units) {
+        tick_handler(current,
+                     changed);
+    }
+}
+
+static
+GBitmap*
+bitmap_allocate(GSize size)
+{
+    GBitmap* result = malloc(sizeof(GBitmap));
+    result->row_size_bytes = ((size.w + 31) / 32) * 4;
+    result->addr = calloc(result->row_size_bytes * (size.h > 0 ? size.h : 1),
+                          1);
+    result->info_flags = bitmap_owns_data;
+    result->bounds = GRect(0, 0, size.w, size.h);
+    return result;
+}
+
+static
+void
+text_layer_update(Layer* layer,
+                  GContext* ctx)
+{
+    text_info_t* info = layer_get_data(layer);
+
+    if (info->background_color != GColorClear) {
+        graphics_context_set_fill_color(ctx,
+                                        info->background_color);
+        graphics_fill_rect(ctx,
+                           GRect(0, 0,
+                                 layer->bounds.size.w,
+                                 layer->bounds.size.h),
+                           0,
+                           GCornerNone);
+    }
+
+    if (info->text) {
+        graphics_context_set_text_color(ctx,
+                                        info->text_color);
+        graphics_draw_text(ctx,
+                           info->text,
+                           info->font,
+                           layer->bounds,
+                           GTextOverflowModeWordWrap,
+                           info->alignment,
+                           NULL);
+    }
+}
+
+static
+void
+inverter_layer_update(Layer* layer,
+                      GContext* ctx)
+{
+    GRect area = GRect(ctx->offset.x, ctx->offset.y,
+                       layer->bounds.size.w, layer->bounds.size.h);
+    area = rect_intersect(area, ctx->clip);
+
+    for (int y = area.origin.y;
+         y < area.origin.y + area.size.h;
+         ++y) {
+        for (int x = area.origin.x;
+             x < area.origin.x + area.size.w;
+             ++x) {
+            framebuffer_set_pixel(ctx->framebuffer,
+                                  x,
+                                  y,
+                                  !framebuffer_get_pixel(ctx->framebuffer,
+                                                         x,
+                                                         y));
+        }
+    }
+
+    stats.pixels_written += area.size.w * area.size.h;
+}
+
+static
+persist_entry_t*
+persist_find(uint32_t key,
+             bool create)
+{
+    persist_entry_t* free_entry = NULL;
+
+    for (unsigned index = 0;
+         index < PERSIST_CAPACITY;
+         ++index) {
+        persist_entry_t* entry = &persist_entries[index];
+
+        if (entry->used && entry->key == key) {
+            return entry;
+        }
+
+        if (!entry->used && !free_entry) {
+            free_entry = entry;
+        }
+    }
+
+    if (create && free_entry) {
+        free_entry->used = true;
+        free_entry->key = key;
+        free_entry->value = 0;
+        return free_entry;
+    }
+
+    return NULL;
+}
+
+static
+void
+dump_frame(const char* directory)
+{
+    char path[4096];
+    snprintf(path,
+             sizeof(path),
+             "%s/frame_%06lu.pbm",
+             directory,
+             stats.frames);
+    host_write_pbm(path);
+}
+
+static
+void
+send_config(const char* config)
+{
+    char* copy = malloc(strlen(config) + 1);
+    strcpy(copy,
+           config);
+    uint32_t keys[64];
+    const char* values[64];
+    unsigned count = 0;
+
+    for (char* item = strtok(copy, ",");
+         item && count < 64;
+         item = strtok(NULL, ",")) {
+        char* separator = strchr(item, '=');
+
+        if (!separator) {
+            continue;
+        }
+
+        *separator = '\0';
+        keys[count] = strtoul(item, NULL, 10);
+        values[count] = separator + 1;
+        ++count;
+    }
+
+    host_send_app_message(keys,
+                          values,
+                          count);
+    free(copy);
+}
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+// MEMORY =
+
+void*
+host_malloc(size_t size)
+{
+    void* result = (malloc)(size);
+
+    if (result) {
+        heap_used += malloc_usable_size(result);
+        ++stats.heap_allocations;
+    }
+
+    return result;
+}
+
+void*
+host_calloc(size_t count,
+            size_t size)
+{
+    void* result = (calloc)(count,
+                            size);
+
+    if (result) {
+        heap_used += malloc_usable_size(result);
+        ++stats.heap_allocations;
+    }
+
+    return result;
+}
+
+void
+host_free(void* pointer)
+{
+    if (pointer) {
+        heap_used -= malloc_usable_size(pointer);
+        ++stats.heap_releases;
+    }
+
+    (free)(pointer);
+}
+
+size_t
+heap_bytes_used(void)
+{
+    return heap_used;
+}
+
+size_t
+heap_bytes_free(void)
+{
+    return heap_used < heap_size ? heap_size - heap_used : 0;
+}
+
+// GRAPHICS =
+
+void
+graphics_context_set_compositing_mode(GContext* ctx,
+                                      GCompOp mode)
+{
+    ctx->compositing_mode = mode;
+}
+
+void
+graphics_context_set_fill_color(GContext* ctx,
+                                GColor color)
+{
+    ctx->fill_color = color;
+}
+
+void
+graphics_context_set_stroke_color(GContext* ctx,
+                                  GColor color)
+{
+    ctx->stroke_color = color;
+}
+
+void
+graphics_context_set_text_color(GContext* ctx,
+                                GColor color)
+{
+    ctx->text_color = color;
+}
+
+void
+graphics_fill_rect(GContext* ctx,
+                   GRect rect,
+                   uint16_t corner_radius,
+                   GCornerMask corner_mask)
+{
+    if (ctx->fill_color == GColorClear) {
+        return;
+    }
+
+    rect.origin.x += ctx->offset.x;
+    rect.origin.y += ctx->offset.y;
+    rect = rect_intersect(rect, ctx->clip);
+
+    for (int y = rect.origin.y;
+         y < rect.origin.y + rect.size.h;
+         ++y) {
+        for (int x = rect.origin.x;
+             x < rect.origin.x + rect.size.w;
+             ++x) {
+            framebuffer_set_pixel(ctx->framebuffer,
+                                  x,
+                                  y,
+                                  ctx->fill_color == GColorWhite);
+        }
+    }
+
+    stats.pixels_written += rect.size.w * rect.size.h;
+}
+
+void
+graphics_draw_bitmap_in_rect(GContext* ctx,
+                             const GBitmap* bitmap,
+                             GRect rect)
+{
+    ++stats.bitmap_blits;
+
+    if (!bitmap ||
+        bitmap->bounds.size.w <= 0 ||
+        bitmap->bounds.size.h <= 0) {
+        return;
+    }
+
+    GPoint origin = GPoint(rect.origin.x + ctx->offset.x,
+                           rect.origin.y + ctx->offset.y);
+    GRect area = rect_intersect(GRect(origin.x, origin.y,
+                                      rect.size.w, rect.size.h),
+                                ctx->clip);
+
+    for (int y = area.origin.y;
+         y < area.origin.y + area.size.h;
+         ++y) {
+        // Bitmaps are tiled when the rect is larger than the bitmap
+        int source_y = (y - origin.y) % bitmap->bounds.size.h;
+
+        for (int x = area.origin.x;
+             x < area.origin.x + area.size.w;
+             ++x) {
+            int source_x = (x - origin.x) % bitmap->bounds.size.w;
+            bool source = bitmap_get_pixel(bitmap,
+                                           source_x,
+                                           source_y);
+            bool destination = framebuffer_get_pixel(ctx->framebuffer,
+                                                     x,
+                                                     y);
+
+            switch (ctx->compositing_mode) {
+            default:
+            case GCompOpAssign:
+                destination = source;
+                break;
+
+            case GCompOpAssignInverted:
+                destination = !source;
+                break;
+
+            case GCompOpOr:
+                destination |= source;
+                break;
+
+            case GCompOpAnd:
+                destination &= source;
+                break;
+
+            case GCompOpClear:
+                destination &= !source;
+                break;
+
+            case GCompOpSet:
+                destination |= !source;
+                break;
+            }
+
+            framebuffer_set_pixel(ctx->framebuffer,
+                                  x,
+                                  y,
+                                  destination);
+        }
+    }
+
+    stats.pixels_written += area.size.w * area.size.h;
+}
+
+void
+graphics_draw_text(GContext* ctx,
+                   const char* text,
+                   const GFont font,
+                   const GRect box,
+                   const GTextOverflowMode overflow_mode,
+                   const GTextAlignment alignment,
+                   const GTextLayoutCacheRef layout)
+{
+    ++stats.text_draws;
+}
+
+GBitmap*
+graphics_capture_frame_buffer(GContext* ctx)
+{
+    return ctx->framebuffer;
+}
+
+bool
+graphics_release_frame_buffer(GContext* ctx,
+                              GBitmap* buffer)
+{
+    return buffer == ctx->framebuffer;
+}
+
+GFont
+fonts_get_system_font(const char* font_key)
+{
+    return &dummy_font;
+}
+
+// BITMAPS =
+
+GBitmap*
+gbitmap_create_with_resource(uint32_t resource_id)
+{
+    if (resource_id == 0 || resource_id > host_resource_count) {
+        APP_LOG(APP_LOG_LEVEL_ERROR,
+                "Invalid resource id %u",
+                (unsigned) resource_id);
+        return NULL;
+    }
+
+    const char* resources_dir = getenv("LIVEDIGITS_HOST_RESOURCES");
+    char path[4096];
+    snprintf(path,
+             sizeof(path),
+             "%s/%s",
+             resources_dir ? resources_dir : "resources",
+             host_resource_files[resource_id - 1]);
+    return host_load_png(path);
+}
+
+GBitmap*
+gbitmap_create_blank(GSize size)
+{
+    return bitmap_allocate(size);
+}
+
+GBitmap*
+gbitmap_create_as_sub_bitmap(const GBitmap* base_bitmap,
+                             GRect sub_rect)
+{
+    GBitmap* result = malloc(sizeof(GBitmap));
+    *result = *base_bitmap;
+    result->info_flags &= ~bitmap_owns_data;
+    result->bounds = sub_rect;
+    result->bounds.origin.x += base_bitmap->bounds.origin.x;
+    result->bounds.origin.y += base_bitmap->bounds.origin.y;
+    return result;
+}
+
+void
+gbitmap_destroy(GBitmap* bitmap)
+{
+    if (!bitmap) {
+        return;
+    }
+
+    if (bitmap->info_flags & bitmap_owns_data) {
+        free(bitmap->addr);
+    }
+
+    free(bitmap);
+}
+
+// LAYERS =
+
+Layer*
+layer_create(GRect frame)
+{
+    return layer_create_with_data(frame,
+                                  0);
+}
+
+Layer*
+layer_create_with_data(GRect frame,
+                       size_t data_size)
+{
+    Layer* result = calloc(1,
+                           sizeof(Layer) + data_size);
+    result->frame = frame;
+    result->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+    result->clips = true;
+    return result;
+}
+
+void
+layer_destroy(Layer* layer)
+{
+    if (!layer) {
+        return;
+    }
+
+    layer_remove_from_parent(layer);
+
+    while (layer->first_child) {
+        layer_remove_from_parent(layer->first_child);
+    }
+
+    free(layer);
+}
+
+void*
+layer_get_data(const Layer* layer)
+{
+    return (void*) layer->data;
+}
+
+void
+layer_set_update_proc(Layer* layer,
+                      LayerUpdateProc update_proc)
+{
+    layer->update_proc = update_proc;
+}
+
+void
+layer_mark_dirty(Layer* layer)
+{
+    ++stats.dirty_marks;
+    need_render = true;
+}
+
+void
+layer_add_child(Layer* parent,
+                Layer* child)
+{
+    layer_remove_from_parent(child);
+    child->parent = parent;
+    Layer** slot = &parent->first_child;
+
+    while (*slot) {
+        slot = &(*slot)->next_sibling;
+    }
+
+    *slot = child;
+    need_render = true;
+}
+
+void
+layer_remove_from_parent(Layer* child)
+{
+    if (!child->parent) {
+        return;
+    }
+
+    Layer** slot = &child->parent->first_child;
+
+    while (*slot && *slot != child) {
+        slot = &(*slot)->next_sibling;
+    }
+
+    if (*slot) {
+        *slot = child->next_sibling;
+    }
+
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    need_render = true;
+}
+
+GRect
+layer_get_frame(const Layer* layer)
+{
+    return layer->frame;
+}
+
+void
+layer_set_frame(Layer* layer,
+                GRect frame)
+{
+    layer->frame = frame;
+    layer->bounds.size = frame.size;
+    need_render = true;
+}
+
+GRect
+layer_get_bounds(const Layer* layer)
+{
+    return layer->bounds;
+}
+
+void
+layer_set_bounds(Layer* layer,
+                 GRect bounds)
+{
+    layer->bounds = bounds;
+    need_render = true;
+}
+
+bool
+layer_get_hidden(const Layer* layer)
+{
+    return layer->hidden;
+}
+
+void
+layer_set_hidden(Layer* layer,
+                 bool hidden)
+{
+    if (layer->hidden != hidden) {
+        layer->hidden = hidden;
+        need_render = true;
+    }
+}
+
+void
+layer_set_clips(Layer* layer,
+                bool clips)
+{
+    layer->clips = clips;
+}
+
+TextLayer*
+text_layer_create(GRect frame)
+{
+    Layer* result = layer_create_with_data(frame,
+                                           sizeof(text_info_t));
+    text_info_t* info = layer_get_data(result);
+    info->text = NULL;
+    info->font = &dummy_font;
+    info->text_color = GColorBlack;
+    info->background_color = GColorWhite;
+    info->alignment = GTextAlignmentLeft;
+    layer_set_update_proc(result,
+                          text_layer_update);
+    return (TextLayer*) result;
+}
+
+void
+text_layer_destroy(TextLayer* text_layer)
+{
+    layer_destroy((Layer*) text_layer);
+}
+
+Layer*
+text_layer_get_layer(TextLayer* text_layer)
+{
+    return (Layer*) text_layer;
+}
+
+void
+text_layer_set_text(TextLayer* text_layer,
+                    const char* text)
+{
+    text_info_t* info = layer_get_data((Layer*) text_layer);
+    info->text = text;
+    layer_mark_dirty((Layer*) text_layer);
+}
+
+void
+text_layer_set_font(TextLayer* text_layer,
+                    GFont font)
+{
+    text_info_t* info = layer_get_data((Layer*) text_layer);
+    info->font = font;
+    layer_mark_dirty((Layer*) text_layer);
+}
+
+void
+text_layer_set_text_color(TextLayer* text_layer,
+                          GColor color)
+{
+    text_info_t* info = layer_get_data((Layer*) text_layer);
+    info->text_color = color;
+    layer_mark_dirty((Layer*) text_layer);
+}
+
+void
+text_layer_set_background_color(TextLayer* text_layer,
+                                GColor color)
+{
+    text_info_t* info = layer_get_data((Layer*) text_layer);
+    info->background_color = color;
+    layer_mark_dirty((Layer*) text_layer);
+}
+
+void
+text_layer_set_text_alignment(TextLayer* text_layer,
+                              GTextAlignment text_alignment)
+{
+    text_info_t* info = layer_get_data((Layer*) text_layer);
+    info->alignment = text_alignment;
+    layer_mark_dirty((Layer*) text_layer);
+}
+
+InverterLayer*
+inverter_layer_create(GRect frame)
+{
+    Layer* result = layer_create(frame);
+    layer_set_update_proc(result,
+                          inverter_layer_update);
+    return (InverterLayer*) result;
+}
+
+void
+inverter_layer_destroy(InverterLayer* inverter_layer)
+{
+    layer_destroy((Layer*) inverter_layer);
+}
+
+Layer*
+inverter_layer_get_layer(InverterLayer* inverter_layer)
+{
+    return (Layer*) inverter_layer;
+}
+
+// WINDOWS =
+
+Window*
+window_create(void)
+{
+    Window* result = calloc(1,
+                            sizeof(Window));
+    result->root_layer = layer_create(GRect(0, 0,
+                                            host_screen_width,
+                                            host_screen_height));
+    result->background_color = GColorWhite;
+    return result;
+}
+
+void
+window_destroy(Window* window)
+{
+    if (window == top_window) {
+        if (window->handlers.disappear) {
+            window->handlers.disappear(window);
+        }
+
+        top_window = NULL;
+    }
+
+    if (window->loaded && window->handlers.unload) {
+        window->handlers.unload(window);
+    }
+
+    layer_destroy(window->root_layer);
+    free(window);
+}
+
+void
+window_set_window_handlers(Window* window,
+                           WindowHandlers handlers)
+{
+    window->handlers = handlers;
+}
+
+Layer*
+window_get_root_layer(const Window* window)
+{
+    return window->root_layer;
+}
+
+void
+window_set_background_color(Window* window,
+                            GColor background_color)
+{
+    window->background_color = background_color;
+    need_render = true;
+}
+
+void
+window_set_user_data(Window* window,
+                     void* data)
+{
+    window->user_data = data;
+}
+
+void*
+window_get_user_data(const Window* window)
+{
+    return window->user_data;
+}
+
+void
+window_stack_push(Window* window,
+                  bool animated)
+{
+    top_window = window;
+
+    if (!window->loaded) {
+        window->loaded = true;
+
+        if (window->handlers.load) {
+            window->handlers.load(window);
+        }
+    }
+
+    if (window->handlers.appear) {
+        window->handlers.appear(window);
+    }
+
+    need_render = true;
+}
+
+// TIMERS =
+
+AppTimer*
+app_timer_register(uint32_t timeout_ms,
+                   AppTimerCallback callback,
+                   void* callback_data)
+{
+    ensure_clock();
+    AppTimer* result = malloc(sizeof(AppTimer));
+    result->deadline = clock_ms + timeout_ms;
+    result->callback = callback;
+    result->callback_data = callback_data;
+    insert_timer(result);
+    return result;
+}
+
+bool
+app_timer_reschedule(AppTimer* timer_handle,
+                     uint32_t new_timeout_ms)
+{
+    if (!remove_timer(timer_handle)) {
+        return false;
+    }
+
+    timer_handle->deadline = clock_ms + new_timeout_ms;
+    insert_timer(timer_handle);
+    return true;
+}
+
+void
+app_timer_cancel(AppTimer* timer_handle)
+{
+    if (remove_timer(timer_handle)) {
+        free(timer_handle);
+    }
+}
+
+// SERVICES =
+
+void
+tick_timer_service_subscribe(TimeUnits units,
+                             TickHandler handler)
+{
+    ensure_clock();
+    tick_units = units;
+    tick_handler = handler;
+}
+
+void
+tick_timer_service_unsubscribe(void)
+{
+    tick_handler = NULL;
+    tick_units = 0;
+}
+
+void
+accel_tap_service_subscribe(AccelTapHandler handler)
+{
+    tap_handler = handler;
+}
+
+void
+accel_tap_service_unsubscribe(void)
+{
+    tap_handler = NULL;
+}
+
+void
+bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler)
+{
+    bt_handler = handler;
+}
+
+void
+bluetooth_connection_service_unsubscribe(void)
+{
+    bt_handler = NULL;
+}
+
+bool
+bluetooth_connection_service_peek(void)
+{
+    return bt_connected;
+}
+
+void
+battery_state_service_subscribe(BatteryStateHandler handler)
+{
+    battery_handler = handler;
+}
+
+void
+battery_state_service_unsubscribe(void)
+{
+    battery_handler = NULL;
+}
+
+BatteryChargeState
+battery_state_service_peek(void)
+{
+    return battery_state;
+}
+
+void
+vibes_short_pulse(void)
+{
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "vibes: short pulse");
+}
+
+void
+vibes_long_pulse(void)
+{
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "vibes: long pulse");
+}
+
+void
+vibes_double_pulse(void)
+{
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "vibes: double pulse");
+}
+
+// MATH =
+
+int32_t
+sin_lookup(int32_t angle)
+{
+    return (int32_t) lround(sin(angle * 2 * M_PI / TRIG_MAX_ANGLE) *
+                            TRIG_MAX_RATIO);
+}
+
+int32_t
+cos_lookup(int32_t angle)
+{
+    return (int32_t) lround(cos(angle * 2 * M_PI / TRIG_MAX_ANGLE) *
+                            TRIG_MAX_RATIO);
+}
+
+// TIME =
+
+time_t
+host_time(time_t* tloc)
+{
+    ensure_clock();
+    time_t result = (time_t)(clock_ms / 1000);
+
+    if (tloc) {
+        *tloc = result;
+    }
+
+    return result;
+}
+
+uint16_t
+time_ms(time_t* tloc,
+        uint16_t* out_ms)
+{
+    ensure_clock();
+    uint16_t result = (uint16_t)(clock_ms % 1000);
+
+    if (tloc) {
+        *tloc = (time_t)(clock_ms / 1000);
+    }
+
+    if (out_ms) {
+        *out_ms = result;
+    }
+
+    return result;
+}
+
+bool
+clock_is_24h_style(void)
+{
+    const char* twelve = getenv("LIVEDIGITS_HOST_12H");
+    return !(twelve && strcmp(twelve, "1") == 0);
+}
+
+WatchInfoColor
+watch_info_get_color(void)
+{
+    return WATCH_INFO_COLOR_BLACK;
+}
+
+// PERSIST =
+
+bool
+persist_exists(const uint32_t key)
+{
+    return persist_find(key, false) != NULL;
+}
+
+int32_t
+persist_read_int(const uint32_t key)
+{
+    persist_entry_t* entry = persist_find(key, false);
+    return entry ? entry->value : 0;
+}
+
+status_t
+persist_write_int(const uint32_t key,
+                  const int32_t value)
+{
+    persist_entry_t* entry = persist_find(key, true);
+
+    if (!entry) {
+        return -1;
+    }
+
+    entry->value = value;
+    return sizeof(int32_t);
+}
+
+bool
+persist_read_bool(const uint32_t key)
+{
+    return persist_read_int(key) != 0;
+}
+
+status_t
+persist_write_bool(const uint32_t key,
+                   const bool value)
+{
+    return persist_write_int(key, value ? 1 : 0);
+}
+
+status_t
+persist_delete(const uint32_t key)
+{
+    persist_entry_t* entry = persist_find(key, false);
+
+    if (entry) {
+        entry->used = false;
+    }
+
+    return 0;
+}
+
+// APP MESSAGE =
+
+Tuple*
+dict_read_first(DictionaryIterator* iter)
+{
+    iter->cursor = 0;
+    return dict_read_next(iter);
+}
+
+Tuple*
+dict_read_next(DictionaryIterator* iter)
+{
+    return (iter->cursor < iter->count)
+           ? iter->tuples[iter->cursor++]
+           : NULL;
+}
+
+AppMessageInboxReceived
+app_message_register_inbox_received(AppMessageInboxReceived received_callback)
+{
+    AppMessageInboxReceived previous = inbox_handler;
+    inbox_handler = received_callback;
+    return previous;
+}
+
+void
+app_message_deregister_callbacks(void)
+{
+    inbox_handler = NULL;
+    free(app_message_buffers);
+    app_message_buffers = NULL;
+}
+
+uint32_t
+app_message_inbox_size_maximum(void)
+{
+    return 2026;
+}
+
+uint32_t
+app_message_outbox_size_maximum(void)
+{
+    return 656;
+}
+
+AppMessageResult
+app_message_open(const uint32_t size_inbound,
+                 const uint32_t size_outbound)
+{
+    free(app_message_buffers);
+    app_message_buffers = malloc(size_inbound + size_outbound);
+    return APP_MSG_OK;
+}
+
+// LOGGING =
+
+void
+app_log(uint8_t log_level,
+        const char* src_filename,
+        int src_line_number,
+        const char* fmt,
+        ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%u] %s:%d> ", log_level, src_filename, src_line_number);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// HOST CONTROLS =
+
+const int host_screen_width = 144;
+const int host_screen_height = 168;
+
+void
+host_set_time(time_t seconds,
+              uint16_t milliseconds)
+{
+    clock_ready = true;
+    clock_ms = ((uint64_t) seconds) * 1000 + milliseconds;
+    last_tick_time = seconds;
+}
+
+uint64_t
+host_get_time_ms(void)
+{
+    ensure_clock();
+    return clock_ms;
+}
+
+void
+host_advance_ms(uint32_t milliseconds)
+{
+    ensure_clock();
+    uint64_t target = clock_ms + milliseconds;
+
+    while (true) {
+        uint64_t next_event = (clock_ms / 1000 + 1) * 1000;
+
+        if (timers && timers->deadline < next_event) {
+            next_event = timers->deadline;
+        }
+
+        if (next_event > target) {
+            break;
+        }
+
+        clock_ms = next_event;
+
+        while (timers && timers->deadline <= clock_ms) {
+            AppTimer* timer = timers;
+            timers = timer->next;
+            AppTimerCallback callback = timer->callback;
+            void* callback_data = timer->callback_data;
+            free(timer);
+            ++stats.timer_wakeups;
+            callback(callback_data);
+        }
+
+        dispatch_tick();
+        host_render();
+    }
+
+    clock_ms = target;
+}
+
+bool
+host_next_timer_ms(uint64_t* deadline)
+{
+    if (!timers) {
+        return false;
+    }
+
+    *deadline = timers->deadline;
+    return true;
+}
+
+bool
+host_render(void)
+{
+    if (!need_render || !top_window) {
+        return false;
+    }
+
+    need_render = false;
+    clear_framebuffer(top_window->background_color);
+    render_layer_tree(top_window->root_layer,
+                      &framebuffer,
+                      GPointZero,
+                      framebuffer.bounds);
+    frame_rendered();
+    return true;
+}
+
+void
+host_render_layer(Layer* layer)
+{
+    need_render = false;
+    clear_framebuffer(GColorBlack);
+    render_layer_tree(layer,
+                      &framebuffer,
+                      GPointZero,
+                      framebuffer.bounds);
+    frame_rendered();
+}
+
+GBitmap*
+host_load_png(const char* path)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&image, path)) {
+        APP_LOG(APP_LOG_LEVEL_ERROR,
+                "Can't load %s: %s",
+                path,
+                image.message);
+        return NULL;
+    }
+
+    image.format = PNG_FORMAT_GA;
+    uint8_t* pixels = malloc(PNG_IMAGE_SIZE(image));
+
+    if (!png_image_finish_read(&image, NULL, pixels, 0, NULL)) {
+        APP_LOG(APP_LOG_LEVEL_ERROR,
+                "Can't decode %s: %s",
+                path,
+                image.message);
+        free(pixels);
+        return NULL;
+    }
+
+    // Same conversion as the SDK: opaque light pixels are white
+    GBitmap* result = bitmap_allocate(GSize(image.width, image.height));
+
+    for (unsigned y = 0;
+         y < image.height;
+         ++y) {
+        for (unsigned x = 0;
+             x < image.width;
+             ++x) {
+            const uint8_t* pixel = pixels + (y * image.width + x) * 2;
+
+            if (pixel[0] >= 128 && pixel[1] >= 128) {
+                framebuffer_set_pixel(result,
+                                      x,
+                                      y,
+                                      true);
+            }
+        }
+    }
+
+    free(pixels);
+    return result;
+}
+
+GBitmap*
+host_get_framebuffer(void)
+{
+    return &framebuffer;
+}
+
+bool
+host_write_pbm(const char* path)
+{
+    FILE* output = fopen(path, "wb");
+
+    if (!output) {
+        APP_LOG(APP_LOG_LEVEL_ERROR,
+                "Can't write %s: %s",
+                path,
+                strerror(errno));
+        return false;
+    }
+
+    fprintf(output, "P4\n%d %d\n", host_screen_width, host_screen_height);
+
+    // PBM is MSB first, and 1 is black
+    for (int y = 0;
+         y < host_screen_height;
+         ++y) {
+        for (int byte = 0;
+             byte < (host_screen_width + 7) / 8;
+             ++byte) {
+            uint8_t packed = 0;
+
+            for (int bit = 0;
+                 bit < 8;
+                 ++bit) {
+                int x = byte * 8 + bit;
+
+                if (x < host_screen_width &&
+                    !framebuffer_get_pixel(&framebuffer, x, y)) {
+                    packed |= 0x80 >> bit;
+                }
+            }
+
+            fputc(packed, output);
+        }
+    }
+
+    fclose(output);
+    return true;
+}
+
+void
+host_set_frame_callback(void (*callback)(void* data),
+                        void* data)
+{
+    frame_callback = callback;
+    frame_callback_data = data;
+}
+
+const host_stats_t*
+host_get_stats(void)
+{
+    return &stats;
+}
+
+void
+host_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+double
+host_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+void
+host_send_tap(AccelAxisType axis,
+              int32_t direction)
+{
+    if (tap_handler) {
+        tap_handler(axis,
+                    direction);
+        host_render();
+    }
+}
+
+void
+host_set_bluetooth(bool connected)
+{
+    bt_connected = connected;
+
+    if (bt_handler) {
+        bt_handler(connected);
+        host_render();
+    }
+}
+
+void
+host_set_battery(BatteryChargeState charge)
+{
+    battery_state = charge;
+
+    if (battery_handler) {
+        battery_handler(charge);
+        host_render();
+    }
+}
+
+void
+host_send_app_message(const uint32_t* keys,
+                      const char* const* values,
+                      unsigned count)
+{
+    if (!inbox_handler) {
+        return;
+    }
+
+    DictionaryIterator iterator;
+    iterator.tuples = malloc(sizeof(Tuple*) * count);
+    iterator.count = count;
+    iterator.cursor = 0;
+
+    for (unsigned index = 0;
+         index < count;
+         ++index) {
+        size_t length = strlen(values[index]) + 1;
+        Tuple* tuple = malloc(sizeof(Tuple) + length + sizeof(uint32_t));
+        tuple->key = keys[index];
+        tuple->type = TUPLE_CSTRING;
+        tuple->length = length;
+        memcpy(tuple->value->cstring, values[index], length);
+        iterator.tuples[index] = tuple;
+    }
+
+    inbox_handler(&iterator,
+                  NULL);
+
+    for (unsigned index = 0;
+         index < count;
+         ++index) {
+        free(iterator.tuples[index]);
+    }
+
+    free(iterator.tuples);
+    host_render();
+}
+
+// EVENT LOOP =
+
+void
+app_event_loop(void)
+{
+    ensure_clock();
+    const char* duration_env = getenv("LIVEDIGITS_HOST_DURATION");
+    const char* frames_dir = getenv("LIVEDIGITS_HOST_FRAMES");
+    const char* taps = getenv("LIVEDIGITS_HOST_TAP");
+    const char* battery = getenv("LIVEDIGITS_HOST_BATTERY");
+    const char* config = getenv("LIVEDIGITS_HOST_CONFIG");
+    uint64_t start = clock_ms;
+    uint64_t end = start + (duration_env
+                            ? strtoull(duration_env, NULL, 10)
+                            : 120) * 1000;
+
+    if (frames_dir) {
+        mkdir(frames_dir, 0755);
+        host_set_frame_callback((void (*)(void*)) dump_frame,
+                                (void*) frames_dir);
+    }
+
+    if (battery) {
+        BatteryChargeState charge = {strtoul(battery, NULL, 10), false, false};
+        host_set_battery(charge);
+    }
+
+    if (config) {
+        send_config(config);
+    }
+
+    host_render();
+
+    while (taps && *taps) {
+        char* next;
+        uint64_t tap_at = start + strtoull(taps, &next, 10) * 1000;
+
+        if (next == taps) {
+            break;
+        }
+
+        if (tap_at > clock_ms && tap_at <= end) {
+            host_advance_ms(tap_at - clock_ms);
+        }
+
+        if (tap_at <= end) {
+            host_send_tap(ACCEL_AXIS_X,
+                          1);
+        }
+
+        taps = (*next == ',') ? next + 1 : next;
+    }
+
+    if (end > clock_ms) {
+        host_advance_ms(end - clock_ms);
+    }
+
+    fprintf(stderr,
+            "frames: %lu, update procs: %lu, blits: %lu, pixels: %lu, "
+            "dirty marks: %lu, timer wakeups: %lu\n",
+            stats.frames,
+            stats.update_procs,
+            stats.bitmap_blits,
+            stats.pixels_written,
+            stats.dirty_marks,
+            stats.timer_wakeups);
+}
@@ -0,0 +1,168 @@
+/** @file
+ * Host-only controls of the Pebble stand-in.
+ *
+ * The host build replace the watch with a simulated clock, a 144x168 1bpp
+ * framebuffer and a few counters. These functions let host tools (and the
+ * default app_event_loop()) drive the simulation and inspect its output.
+ *
+ * app_event_loop() reads its settings from the environment:
+ * - LIVEDIGITS_HOST_START: simulated start time (UNIX time, default: now)
+ * - LIVEDIGITS_HOST_DURATION: simulated run time in seconds (default: 120)
+ * - LIVEDIGITS_HOST_FRAMES: directory where each rendered frame is dumped as
+ *   frame_NNNNNN.pbm (default: no dump)
+ * - LIVEDIGITS_HOST_TAP: comma-separated list of seconds (relative to start)
+ *   at which a tap event is sent
+ * - LIVEDIGITS_HOST_RESOURCES: path to the resources directory (default:
+ *   "resources")
+ * - LIVEDIGITS_HOST_12H: set to 1 to use the 12h clock style
+ * - LIVEDIGITS_HOST_BATTERY: battery charge in percent, not charging
+ *   (default: 80)
+ * - LIVEDIGITS_HOST_CONFIG: comma-separated list of KEY=VALUE settings, sent
+ *   as a configuration message on start. Keys are the numeric values defined
+ *   in the generated src/config.h (CFG_KEY_...); booleans are 1 or 0.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_PEBBLE_HOST_H
+#define INCL_PEBBLE_HOST_H
+
+#include <pebble.h>
+
+// =======
+// TYPES =
+// =======
+
+/** Rendering and heap counters, accumulated until host_reset_stats() */
+typedef struct {
+    /** Number of frames rendered */
+    unsigned long frames;
+    /** Number of layer update procs called */
+    unsigned long update_procs;
+    /** Number of graphics_draw_bitmap_in_rect() calls */
+    unsigned long bitmap_blits;
+    /** Number of framebuffer pixels written by blits and fills */
+    unsigned long pixels_written;
+    /** Number of graphics_draw_text() calls */
+    unsigned long text_draws;
+    /** Number of layer_mark_dirty() calls */
+    unsigned long dirty_marks;
+    /** Number of timer callbacks fired */
+    unsigned long timer_wakeups;
+    /** Number of heap blocks allocated */
+    unsigned long heap_allocations;
+    /** Number of heap blocks released */
+    unsigned long heap_releases;
+} host_stats_t;
+
+// =========
+// EXTERNS =
+// =========
+
+/** Framebuffer width */
+extern const int host_screen_width;
+
+/** Framebuffer height */
+extern const int host_screen_height;
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Set the simulated wall clock. */
+void
+host_set_time(time_t seconds,
+              uint16_t milliseconds);
+
+/** Return the simulated wall clock in milliseconds. */
+uint64_t
+host_get_time_ms(void);
+
+/** Advance the simulated clock, firing timers and tick events on the way.
+ *
+ * Every time an event is fired, the screen is rendered if a layer was marked
+ * dirty.
+ */
+void
+host_advance_ms(uint32_t milliseconds);
+
+/** Return the deadline of the earliest registered timer.
+ *
+ * @return false if no timer is registered
+ */
+bool
+host_next_timer_ms(uint64_t* deadline);
+
+/** Render the pushed window if any layer was marked dirty.
+ *
+ * @return true if a frame was rendered
+ */
+bool
+host_render(void);
+
+/** Render a standalone layer tree into the framebuffer.
+ *
+ * The framebuffer is cleared to black first. This is meant for tools that
+ * drive a single layer without a window.
+ */
+void
+host_render_layer(Layer* layer);
+
+/** Load a PNG file as a 1bpp bitmap, converted like the SDK does.
+ *
+ * @return NULL if the file could not be loaded
+ */
+GBitmap*
+host_load_png(const char* path);
+
+/** Return the framebuffer. */
+GBitmap*
+host_get_framebuffer(void);
+
+/** Dump the framebuffer as a binary PBM file. */
+bool
+host_write_pbm(const char* path);
+
+/** Set a callback called after each rendered frame. */
+void
+host_set_frame_callback(void (*callback)(void* data),
+                        void* data);
+
+/** Return the rendering counters. */
+const host_stats_t*
+host_get_stats(void);
+
+/** Reset the rendering counters. */
+void
+host_reset_stats(void);
+
+/** Return the real monotonic time in nanoseconds, to time the host tools. */
+double
+host_now_ns(void);
+
+/** Send a tap event to the accel tap service subscriber. */
+void
+host_send_tap(AccelAxisType axis,
+              int32_t direction);
+
+/** Change the Bluetooth state, notifying the subscriber. */
+void
+host_set_bluetooth(bool connected);
+
+/** Change the battery state, notifying the subscriber. */
+void
+host_set_battery(BatteryChargeState charge);
+
+/** Send a configuration message to the app message inbox handler.
+ *
+ * @param keys Tuple keys
+ * @param values Tuple values, sent as cstring
+ * @param count Number of tuples
+ */
+void
+host_send_app_message(const uint32_t* keys,
+                      const char* const* values,
+                      unsigned count);
+
+#endif
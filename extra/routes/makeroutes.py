@@ -0,0 +1,269 @@
+#!/usr/bin/env python
+
+"""Build the shortest digit transition table.
+
+From a static digit, an animation can follow two transitions: the next digit
+(next_animation) or a shortcut to 0 (QUICK_NEXT below, the runtime only
+knows them through the route tables). Each transition is a chain
+of animation steps ending on another static digit, and can also be played
+backward, from the digit it ends on to the digit it starts from, by following
+previous_animation. This script reads these transitions from the animation
+tables of src/digits/digit_anim.c, computes the cheapest path between every
+pair of digits, and writes, for each pair, the first animation step to take
+from the starting digit. Steps played backward are flagged with ROUTE_REVERSE.
+
+Routes are computed with and without the shortcuts to 0 (quick wrap), each
+with two cost models (see digit_routes.h):
+- ROUTE_COST_STEPS: every animation step costs the same number of frames
+- ROUTE_COST_MERGED: steps of two-step transitions are played twice faster,
+  like with the FAST_MERGED animation speed. Such a step still takes a bit
+  more than half the frames of a full step, so costs are counted in frames:
+  counting them as half steps would tie paths that are one frame apart
+
+When two paths have the same cost, the one going through fewer digits is
+preferred, then the one starting with next_animation, to keep the usual
+counting order, then the shortcut to 0, then the transitions played
+backward.
+
+The animation tables are checked first, and the script fails if a
+transition does not end on the expected static digit: following
+next_animation must count to the next digit, following QUICK_NEXT must reach
+0, and following previous_animation back from the end of a transition must
+return to the digit it started from. The C compiler cannot check these, and a
+broken chain would only show as a digit animation looping forever.
+"""
+
+import os.path
+import re
+import sys
+
+DIGITS = 10
+
+# Route tables, without then with the shortcuts to 0
+EDGES = ['ROUTE_COUNTING', 'ROUTE_QUICK_WRAP']
+
+# Relative cost of a step for each cost model, in frames with the default 9
+# frames per step
+COST_MODELS = [
+    ('ROUTE_COST_STEPS', lambda multipart: 9),
+    ('ROUTE_COST_MERGED', lambda multipart: 5 if multipart else 9),
+]
+
+# First step of the shortcut to 0 of each static digit, for quick wrap. 0 has
+# none, and 9 counts to 0 anyway. This list is the only definition of the
+# shortcuts; fuzz-digits (extra/host) checks that the routes taking them are
+# never slower than counting, and faster to 0.
+QUICK_NEXT = [None, 'DA_1_TO_0_a', 'DA_2_TO_0', 'DA_3_TO_0', 'DA_4_TO_0_a',
+              'DA_5_TO_0', 'DA_6_TO_0', 'DA_7_TO_0_a', 'DA_8_TO_0', None]
+
+ROW_PATTERN = re.compile(r'\{\s*0x[0-9A-Fa-f]+\s*,\s*\{\s*\w+\s*,\s*\w+\s*\}\s*,'
+                         r'\s*(\w+)\s*,\s*(\w+)\s*,'
+                         r'\s*(true|false)\s*\}')
+
+def readAnimEnum(headerPath):
+    "Return a dict of digit_anim_t names to values"
+    with open(headerPath, 'r') as inFile:
+        content = inFile.read()
+    body = re.search(r'typedef enum \{([^}]*)\} digit_anim_t;', content).group(1)
+    values = {}
+    value = 0
+    for item in body.split(','):
+        item = item.strip()
+        if not item:
+            continue
+        if '=' in item:
+            name, value = [part.strip() for part in item.split('=')]
+            value = int(value)
+        else:
+            name = item
+        values[name] = value
+        value += 1
+    return values
+
+def readAnimTable(content, tableName):
+    """Return the rows of an animation table as (next, previous, multipart)
+    tuples"""
+    start = content.index(tableName)
+    body = content[content.index('{', start) + 1:content.index('};', start)]
+    return [(next, previous, multipart == 'true')
+            for next, previous, multipart in ROW_PATTERN.findall(body)]
+
+def readAnimSteps(sourcePath, headerPath):
+    """Return a dict of digit_anim_t values to (name, next, previous, quick,
+    multipart), next, previous and quick being digit_anim_t values.
+
+    quick is the first step of the shortcut to 0 (QUICK_NEXT) for static
+    digits, next_animation if there is none, and None for the other steps."""
+    names = readAnimEnum(headerPath)
+    byValue = dict((value, name) for name, value in names.items())
+    with open(sourcePath, 'r') as inFile:
+        content = inFile.read()
+    rows = ([(index + 1, row)
+             for index, row in enumerate(readAnimTable(content, 'moving_anim[]'))] +
+            [(-index - 1, row)
+             for index, row in enumerate(readAnimTable(content, 'static_anim[10]'))])
+    if len(rows) != len(names):
+        raise ValueError('%s: %i animation steps read, %i expected' %
+                         (sourcePath, len(rows), len(names)))
+    quickNext = lambda value, next: (names[QUICK_NEXT[-value - 1] or next]
+                                     if value < 0 else None)
+    return dict((value, (byValue[value], names[next], names[previous],
+                         quickNext(value, next), multipart))
+                for value, (next, previous, multipart) in rows)
+
+def followTransition(steps, firstStep, stepCost, reverse=False):
+    """Return (digit reached, cost) of a transition starting at firstStep.
+
+    The transition follows next_animation, or previous_animation if reverse
+    is set. The cost is a (frames, transitions) tuple, so that paths are
+    compared on their frames first."""
+    frames = 0
+    step = firstStep
+    visited = set()
+    while step > 0:
+        if step in visited or step not in steps:
+            raise ValueError('%s: transition does not end on a static digit' %
+                             steps[firstStep][0])
+        visited.add(step)
+        frames += stepCost(steps[step][4])
+        step = steps[step][2 if reverse else 1]
+    return (-step - 1, (frames, 1))
+
+def checkAnimSteps(steps):
+    "Raise ValueError if a transition of the animation tables is broken"
+    for step in steps:
+        if step > 0:
+            followTransition(steps, step, lambda multipart: 0)
+            followTransition(steps, step, lambda multipart: 0, True)
+    for digit in range(DIGITS):
+        name, next, previous, quick, multipart = steps[-digit - 1]
+        transitions = [(next, (digit + 1) % DIGITS)]
+        if digit != 0:
+            transitions.append((quick, 0))
+        for firstStep, expected in transitions:
+            if firstStep < 0:
+                raise ValueError('%s: transition starts on a static digit' %
+                                 name)
+            reached = followTransition(steps, firstStep,
+                                       lambda multipart: 0)[0]
+            if reached != expected:
+                raise ValueError('%s: %s reaches %i instead of %i' %
+                                 (name, steps[firstStep][0], reached,
+                                  expected))
+            back = followTransition(steps, lastStep(steps, firstStep),
+                                    lambda multipart: 0, True)[0]
+            if back != digit:
+                raise ValueError('%s: %s played backward reaches %i' %
+                                 (name, steps[firstStep][0], back))
+        if lastStep(steps, previous) != previous or \
+                steps[previous][1] != -digit - 1:
+            raise ValueError('%s: previous_animation does not end on it' %
+                             name)
+
+def lastStep(steps, firstStep):
+    "Return the last animation step of a transition starting at firstStep"
+    step = firstStep
+    while steps[step][1] > 0:
+        step = steps[step][1]
+    return step
+
+def addCosts(first, second):
+    "Return the cost of two paths one after the other"
+    return (first[0] + second[0], first[1] + second[1])
+
+def computeRoutes(steps, stepCost, quickWrap):
+    """Return the first step to take, as route[from][to]
+
+    Shortcuts to 0 are only taken if quickWrap is set."""
+    # Transitions leaving each digit, preferred one first, as
+    # ((first step, reverse), digit reached, cost)
+    edges = [[] for digit in range(DIGITS)]
+    backwardEdges = [[] for digit in range(DIGITS)]
+    for digit in range(DIGITS):
+        static = steps[-digit - 1]
+        firstSteps = [static[1]]
+        if quickWrap and static[3] != static[1]:
+            firstSteps.append(static[3])
+        for firstStep in firstSteps:
+            reached, cost = followTransition(steps, firstStep, stepCost)
+            edges[digit].append(((firstStep, False), reached, cost))
+            # The same transition, played backward from the digit it reaches
+            backwardEdges[reached].append(((lastStep(steps, firstStep), True),
+                                           digit, cost))
+    for digit in range(DIGITS):
+        # Counting down first
+        backwardEdges[digit].sort(key=lambda edge: (edge[1] + 1 - digit) % DIGITS)
+        edges[digit] += backwardEdges[digit]
+    infinity = (float('inf'), 0)
+    distance = [[(0, 0) if source == target else infinity
+                 for target in range(DIGITS)]
+                for source in range(DIGITS)]
+    for source in range(DIGITS):
+        for firstStep, target, cost in edges[source]:
+            distance[source][target] = min(distance[source][target], cost)
+    for middle in range(DIGITS):
+        for source in range(DIGITS):
+            for target in range(DIGITS):
+                through = addCosts(distance[source][middle],
+                                   distance[middle][target])
+                if through < distance[source][target]:
+                    distance[source][target] = through
+    routes = []
+    for source in range(DIGITS):
+        row = []
+        for target in range(DIGITS):
+            if source == target:
+                row.append(steps[-source - 1][0])
+                continue
+            best = None
+            for firstStep, reached, cost in edges[source]:
+                total = addCosts(cost, distance[reached][target])
+                if best is None or total < best[1]:
+                    best = (firstStep, total)
+            firstStep, reverse = best[0]
+            row.append(steps[firstStep][0] + (' | ROUTE_REVERSE' if reverse
+                                              else ''))
+        routes.append(row)
+    return routes
+
+def writeRoutes(routesByEdges, outPath):
+    "Write the route tables as C source"
+    with open(outPath, 'w') as output:
+        output.write('/* GENERATED FILE DO NOT MODIFY */\n'
+                     '#include <pebble.h>\n'
+                     '\n'
+                     '#include "digit_routes.h"\n'
+                     '\n'
+                     'const int8_t digit_routes[ROUTE_EDGES_COUNT][ROUTE_COST_COUNT]\n'
+                     '                        [DIGIT_ROUTE_COUNT][DIGIT_ROUTE_COUNT] = {\n')
+        for edgesName, routesByModel in zip(EDGES, routesByEdges):
+            output.write('    // %s\n'
+                         '    {\n' % edgesName)
+            for (modelName, _), routes in zip(COST_MODELS, routesByModel):
+                output.write('        // %s\n'
+                             '        {\n' % modelName)
+                for source, row in enumerate(routes):
+                    output.write('            // From %i\n'
+                                 '            {%s},\n' % (source, ', '.join(row)))
+                output.write('        },\n')
+            output.write('    },\n')
+        output.write('};\n')
+
+def main(sourcePath, headerPath, routesPath):
+    """Write the route tables in routesPath from the animation steps in
+    sourcePath/headerPath"""
+    steps = readAnimSteps(sourcePath, headerPath)
+    checkAnimSteps(steps)
+    writeRoutes([[computeRoutes(steps, stepCost, quickWrap)
+                  for _, stepCost in COST_MODELS]
+                 for quickWrap in range(len(EDGES))],
+                routesPath)
+
+if __name__ == '__main__':
+    digitsDir = os.path.join('src', 'digits')
+    main(sys.argv[1] if len(sys.argv) > 1
+         else os.path.join(digitsDir, 'digit_anim.c'),
+         sys.argv[2] if len(sys.argv) > 2
+         else os.path.join(digitsDir, 'digit_anim.h'),
+         sys.argv[3] if len(sys.argv) > 3
+         else os.path.join(digitsDir, 'digit_routes.auto.c'))
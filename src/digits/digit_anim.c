@@ -7,6 +7,7 @@
 
 #include <pebble.h>
 
+#include "utils.h"
 #include "digit_info.h"
 
 #include "digit_anim.h"
@@ -15,16 +16,28 @@
 // PRIVATE TYPES =
 // ===============
 
-/** All info about a digit animation step. */
+/** All info about a digit animation step.
+ *
+ * Enumerations are stored in a byte each (segment_anim_t and digit_anim_t
+ * values all fit in an int8_t), so a step takes 6 bytes instead of 24.
+ *
+ * The shortcuts to 0 taken with quick wrap are not stored here: they only
+ * exist in the route tables (see digit_routes.h), which
+ * extra/routes/makeroutes.py builds from these steps.
+ */
 typedef struct {
     /** The segments to statically display (not animated) */
     digit_fixed_segments_t fixed_segments;
-    /** The animated segments (up to two) */
-    digit_segment_animation_t moving_segments;
+    /** The animated segments (up to two, segment_anim_t values) */
+    int8_t moving_segments[2];
     /** The next animation step in the sequence */
-    digit_anim_t next_animation;
-    /** The shortcut animation to 0 */
-    digit_anim_t quick_next;
+    int8_t next_animation;
+    /** The previous animation step in the sequence, to play it backward.
+     *
+     * For a static digit, this is the last step of the transition counting up
+     * to it.
+     */
+    int8_t previous_animation;
     /** If the animation is part of a two-step transition. */
     bool multipart;
 } digit_anim_info_t;
@@ -36,14 +49,16 @@ typedef struct {
  * steps is a combination of an offset (this data type) and an orientation (in
  * animated_segment_orientation_t).
  */
-typedef const GPoint animated_segment_offset_t[7 * 9];
+typedef const segment_offset_t
+animated_segment_offset_t[7 * ANIM_KEYFRAME_COUNT];
 
 /** All segment orientation when animated.
  *
  * See animated_segment_offset_t for details about the composition of this
- * array.
+ * array. Values are segment_orientation_t.
  */
-typedef const segment_orientation_t animated_segment_orientation_t[7 * 9];
+typedef const uint8_t
+animated_segment_orientation_t[7 * ANIM_KEYFRAME_COUNT];
 
 // ==============
 // PRIVATE DATA =
@@ -156,57 +171,57 @@ animated_segment_offset_t animated_segment_offsets[DIGITS_SIZE_COUNT] = {
  */
 static const digit_anim_info_t moving_anim[] = {
     // 1 - 0>1
-    {0x65, {SA_1_TO_0, SA_4_TO_6}, DA_0_TO_1_b, DA_0_TO_1_b, true},
+    {0x65, {SA_1_TO_0, SA_4_TO_6}, DA_0_TO_1_b, DA_0, true},
     // 2 - 0>1
-    {0x24, {SA_0_TO_2, SA_6_TO_5}, DA_1, DA_1, true},
+    {0x24, {SA_0_TO_2, SA_6_TO_5}, DA_1, DA_0_TO_1_a, true},
     // 3 - 1>2
-    {0x04, {SA_2_TO_0, SA_5_TO_6}, DA_1_TO_2_b, DA_1_TO_2_b, true},
+    {0x04, {SA_2_TO_0, SA_5_TO_6}, DA_1_TO_2_b, DA_1, true},
     // 4 - 1>2
-    {0x45, {SA_2_TO_3, SA_6_TO_4}, DA_2, DA_2, true},
+    {0x45, {SA_2_TO_3, SA_6_TO_4}, DA_2, DA_1_TO_2_a, true},
     // 5 - 2>3
-    {0x4D, {SA_4_TO_6, SA_NOANIM}, DA_2_TO_3_b, DA_2_TO_3_b, true},
+    {0x4D, {SA_4_TO_6, SA_NOANIM}, DA_2_TO_3_b, DA_2, true},
     // 6 - 2>3
-    {0x4D, {SA_6_TO_5, SA_NOANIM}, DA_3, DA_3, true},
+    {0x4D, {SA_6_TO_5, SA_NOANIM}, DA_3, DA_2_TO_3_a, true},
     // 7 - 3>4
-    {0x2C, {SA_0_TO_1, SA_6_TO_5}, DA_4, DA_4, false},
+    {0x2C, {SA_0_TO_1, SA_6_TO_5}, DA_4, DA_3, false},
     // 8 - 4>5
-    {0x2A, {SA_2_TO_0, SA_5_TO_6}, DA_5, DA_5, false},
+    {0x2A, {SA_2_TO_0, SA_5_TO_6}, DA_5, DA_4, false},
     // 9 - 5>6
-    {0x6B, {SA_3_TO_4, SA_NOANIM}, DA_6, DA_6, false},
+    {0x6B, {SA_3_TO_4, SA_NOANIM}, DA_6, DA_5, false},
     // 10 - 6>7
-    {0x63, {SA_3_TO_2, SA_4_TO_6}, DA_6_TO_7_b, DA_6_TO_7_b, true},
+    {0x63, {SA_3_TO_2, SA_4_TO_6}, DA_6_TO_7_b, DA_6, true},
     // 11 - 6>7
-    {0x25, {SA_1_TO_0, SA_6_TO_5}, DA_7, DA_7, true},
+    {0x25, {SA_1_TO_0, SA_6_TO_5}, DA_7, DA_6_TO_7_a, true},
     // 12 - 7>8
-    {0x25, {SA_0_TO_1, SA_5_TO_6}, DA_7_TO_8_b, DA_7_TO_8_b, true},
+    {0x25, {SA_0_TO_1, SA_5_TO_6}, DA_7_TO_8_b, DA_7, true},
     // 13 - 7>8
-    {0x67, {SA_1_TO_3, SA_6_TO_4}, DA_8, DA_8, true},
+    {0x67, {SA_1_TO_3, SA_6_TO_4}, DA_8, DA_7_TO_8_a, true},
     // 14 - 8>9
-    {0x6F, {SA_4_TO_3, SA_NOANIM}, DA_9, DA_9, false},
+    {0x6F, {SA_4_TO_3, SA_NOANIM}, DA_9, DA_8, false},
     // 15 - 9>0
-    {0x67, {SA_3_TO_1, SA_6_TO_4}, DA_0, DA_0, false},
+    {0x67, {SA_3_TO_1, SA_6_TO_4}, DA_0, DA_9, false},
     // 16 - 1>0
-    {0x24, {SA_2_TO_0, SA_5_TO_6}, DA_1_TO_0_b, DA_1_TO_0_b, true},
+    {0x24, {SA_2_TO_0, SA_5_TO_6}, DA_1_TO_0_b, DA_1, true},
     // 17 - 1>0
-    {0x65, {SA_0_TO_1, SA_6_TO_4}, DA_0, DA_0, true},
+    {0x65, {SA_0_TO_1, SA_6_TO_4}, DA_0, DA_1_TO_0_a, true},
     // 18 - 2>0
-    {0x55, {SA_3_TO_1, SA_6_TO_5}, DA_0, DA_0, false},
+    {0x55, {SA_3_TO_1, SA_6_TO_5}, DA_0, DA_2, false},
     // 19 - 3>0
-    {0x65, {SA_3_TO_4, SA_0_TO_1}, DA_0, DA_0, false},
+    {0x65, {SA_3_TO_4, SA_0_TO_1}, DA_0, DA_3, false},
     // 20 - 4>0
-    {0x26, {SA_3_TO_4, SA_NOANIM}, DA_4_TO_0_b, DA_4_TO_0_b, true},
+    {0x26, {SA_3_TO_4, SA_NOANIM}, DA_4_TO_0_b, DA_4, true},
     // 21 - 4>0
-    {0x36, {SA_5_TO_6, SA_1_TO_0}, DA_0, DA_0, true},
+    {0x36, {SA_5_TO_6, SA_1_TO_0}, DA_0, DA_4_TO_0_a, true},
     // 22 - 5>0
-    {0x63, {SA_0_TO_2, SA_6_TO_4}, DA_0, DA_0, false},
+    {0x63, {SA_0_TO_2, SA_6_TO_4}, DA_0, DA_5, false},
     // 23 - 6>0
-    {0x73, {SA_3_TO_2, SA_NOANIM}, DA_0, DA_0, false},
+    {0x73, {SA_3_TO_2, SA_NOANIM}, DA_0, DA_6, false},
     // 24 - 7>0
-    {0x25, {SA_5_TO_6, SA_0_TO_1}, DA_7_TO_0_b, DA_7_TO_0_b, true},
+    {0x25, {SA_5_TO_6, SA_0_TO_1}, DA_7_TO_0_b, DA_7, true},
     // 25 - 7>0
-    {0x67, {SA_6_TO_4, SA_NOANIM}, DA_0, DA_0, true},
+    {0x67, {SA_6_TO_4, SA_NOANIM}, DA_0, DA_7_TO_0_a, true},
     // 26 - 8>0
-    {0x77, {SA_3_TO_4, SA_NOANIM}, DA_0, DA_0, false}
+    {0x77, {SA_3_TO_4, SA_NOANIM}, DA_0, DA_8, false}
 };
 
 /** Digit animation steps.
@@ -216,27 +231,38 @@ static const digit_anim_info_t moving_anim[] = {
  */
 static const digit_anim_info_t static_anim[10] = {
     // -1 - 0
-    {0x77, {SA_NOANIM, SA_NOANIM}, DA_0_TO_1_a, DA_0_TO_1_a, false},
+    {0x77, {SA_NOANIM, SA_NOANIM}, DA_0_TO_1_a, DA_9_TO_0, false},
     // -2 - 1
-    {0x24, {SA_NOANIM, SA_NOANIM}, DA_1_TO_2_a, DA_1_TO_0_a, false},
+    {0x24, {SA_NOANIM, SA_NOANIM}, DA_1_TO_2_a, DA_0_TO_1_b, false},
     // -3 - 2
-    {0x5D, {SA_NOANIM, SA_NOANIM}, DA_2_TO_3_a, DA_2_TO_0, false},
+    {0x5D, {SA_NOANIM, SA_NOANIM}, DA_2_TO_3_a, DA_1_TO_2_b, false},
     // -4 - 3
-    {0x6D, {SA_NOANIM, SA_NOANIM}, DA_3_TO_4, DA_3_TO_0, false},
+    {0x6D, {SA_NOANIM, SA_NOANIM}, DA_3_TO_4, DA_2_TO_3_b, false},
     // -5 - 4
-    {0x2E, {SA_NOANIM, SA_NOANIM}, DA_4_TO_5, DA_4_TO_0_a, false},
+    {0x2E, {SA_NOANIM, SA_NOANIM}, DA_4_TO_5, DA_3_TO_4, false},
     // -6 - 5
-    {0x6B, {SA_NOANIM, SA_NOANIM}, DA_5_TO_6, DA_5_TO_0, false},
+    {0x6B, {SA_NOANIM, SA_NOANIM}, DA_5_TO_6, DA_4_TO_5, false},
     // -7 - 6
-    {0x7B, {SA_NOANIM, SA_NOANIM}, DA_6_TO_7_a, DA_6_TO_0, false},
+    {0x7B, {SA_NOANIM, SA_NOANIM}, DA_6_TO_7_a, DA_5_TO_6, false},
     // -8 - 7
-    {0x25, {SA_NOANIM, SA_NOANIM}, DA_7_TO_8_a, DA_7_TO_0_a, false},
+    {0x25, {SA_NOANIM, SA_NOANIM}, DA_7_TO_8_a, DA_6_TO_7_b, false},
     // -9 - 8
-    {0x7F, {SA_NOANIM, SA_NOANIM}, DA_8_TO_9, DA_8_TO_0, false},
+    {0x7F, {SA_NOANIM, SA_NOANIM}, DA_8_TO_9, DA_7_TO_8_b, false},
     // -10 - 9
-    {0x6F, {SA_NOANIM, SA_NOANIM}, DA_9_TO_0, DA_9_TO_0, false}
+    {0x6F, {SA_NOANIM, SA_NOANIM}, DA_9_TO_0, DA_8_TO_9, false}
 };
 
+// The packed tables must hold every value. The content of the transitions is
+// checked by extra/routes/makeroutes.py when the project is configured.
+STATIC_ASSERT(ARRAY_COUNT(moving_anim) == DA_8_TO_0,
+              one_moving_anim_per_step);
+STATIC_ASSERT(DA_8_TO_0 <= INT8_MAX && DA_9 >= INT8_MIN,
+              digit_anim_fits_int8);
+STATIC_ASSERT(SEGMENTS_ORIENTATION_COUNT <= UINT8_MAX,
+              orientation_fits_uint8);
+STATIC_ASSERT(sizeof(digit_anim_info_t) == 6,
+              digit_anim_info_packed);
+
 // ================================
 // PRIVATE FUNCTIONS DECLARATIONS =
 // ================================
@@ -262,17 +288,41 @@ retrieve_anim(digit_anim_t digit_anim)
 segment_orientation_t
 anim_segment_get(segment_anim_t segment_anim,
                  int anim_pos,
+                 int step_count,
                  digit_size_t digit_size,
                  GPoint* offset)
 {
     if (segment_anim < 0) {
         segment_anim = -segment_anim;
-        anim_pos = 8 - anim_pos;
+        anim_pos = step_count - 1 - anim_pos;
     }
 
     --segment_anim;
-    *offset = animated_segment_offsets[digit_size][segment_anim * 9 + anim_pos];
-    return animated_segment_orientation[segment_anim * 9 + anim_pos];
+    const segment_offset_t* offsets =
+        &animated_segment_offsets[digit_size][segment_anim *
+                                              ANIM_KEYFRAME_COUNT];
+    const uint8_t* orientations =
+        &animated_segment_orientation[segment_anim * ANIM_KEYFRAME_COUNT];
+
+    // Position in keyframes, in 1/256th
+    int position = anim_pos * (ANIM_KEYFRAME_COUNT - 1) * 256 /
+                   (step_count - 1);
+    int keyframe = position >> 8;
+    int fraction = position & 0xff;
+
+    if (keyframe >= ANIM_KEYFRAME_COUNT - 1) {
+        *offset = GPoint(offsets[ANIM_KEYFRAME_COUNT - 1].x,
+                         offsets[ANIM_KEYFRAME_COUNT - 1].y);
+        return orientations[ANIM_KEYFRAME_COUNT - 1];
+    }
+
+    const segment_offset_t* from = &offsets[keyframe];
+    const segment_offset_t* to = &offsets[keyframe + 1];
+    offset->x = (from->x * (256 - fraction) + to->x * fraction + 128) >> 8;
+    offset->y = (from->y * (256 - fraction) + to->y * fraction + 128) >> 8;
+    return orientations[fraction < 128
+                        ? keyframe
+                        : keyframe + 1];
 }
 
 digit_fixed_segments_t
@@ -281,10 +331,11 @@ anim_get_fixed_segments(digit_anim_t digit_anim)
     return retrieve_anim(digit_anim)->fixed_segments;
 }
 
-const digit_segment_animation_t*
-anim_get_segment_anim(digit_anim_t digit_anim)
+segment_anim_t
+anim_get_segment_anim(digit_anim_t digit_anim,
+                      unsigned index)
 {
-    return &retrieve_anim(digit_anim)->moving_segments;
+    return retrieve_anim(digit_anim)->moving_segments[index];
 }
 
 digit_anim_t
@@ -294,9 +345,9 @@ anim_get_next_anim(digit_anim_t digit_anim)
 }
 
 digit_anim_t
-anim_get_next_quick_anim(digit_anim_t digit_anim)
+anim_get_previous_anim(digit_anim_t digit_anim)
 {
-    return retrieve_anim(digit_anim)->quick_next;
+    return retrieve_anim(digit_anim)->previous_animation;
 }
 
 bool
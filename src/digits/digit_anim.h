@@ -5,15 +5,19 @@
  * of each segments.
  *
  * An "animation" is identified by a numeric id. Each animation is made of 9
- * steps, and some animations are marked as either "solo" or "double". Double
+ * keyframes, and some animations are marked as either "solo" or "double". Double
  * animations mean that two animations steps are needed to move from one digit
  * to another, and are sped up in "merge" animation speed.
  *
  * To summarize:
  * A digit animation = [fixed segments, two animated segments, next animation]
- * An animated segments = 9 steps of [position, orientation]
- * To animate, first get through the 9 steps of a segment animation, placing the
+ * An animated segments = 9 keyframes of [position, orientation]
+ * To animate, first get through the frames of a segment animation, placing the
  * segments as indicated, then move to the next animation step of the digit.
+ * Steps can also be played backward, from their last frame to their first,
+ * then moving to the previous animation step: this is how digits count down.
+ * The number of frames of a step is configurable: positions are interpolated
+ * between the keyframes, and orientations snapped to the nearest keyframe.
  *
  * Segments images are provided by digit_images
  * Actual animation logic with different speed is handled in digitlayer
@@ -29,6 +33,13 @@
 
 #include "digit_info.h"
 
+// ========
+// CONSTS =
+// ========
+
+/** Number of keyframes of a segment animation */
+#define ANIM_KEYFRAME_COUNT 9
+
 // =======
 // TYPES =
 // =======
@@ -60,6 +71,10 @@ typedef enum {
  * steps are suffixed with _a and _b.
  * Full digits are treated as "special" animations. They animate no digit but
  * provide the list of segments that must be displayed for a given number.
+ *
+ * The steps to 0 after DA_9_TO_0 are the shortcuts taken with quick wrap.
+ * Which step starts the shortcut of each digit is only defined by QUICK_NEXT
+ * in extra/routes/makeroutes.py.
  */
 typedef enum {
     DA_9 = -10, DA_8, DA_7, DA_6, DA_5, DA_4, DA_3, DA_2, DA_1, DA_0,
@@ -89,13 +104,6 @@ typedef enum {
  */
 typedef uint8_t digit_fixed_segments_t;
 
-/** Represent which segments animation must be displayed.
- * Each animation step can have at most two segment animations.
- * These values are passed back to anim_segment_get() to get the actual segment
- * placement.
- */
-typedef segment_anim_t digit_segment_animation_t[2];
-
 // ===============================
 // PUBLIC FUNCTIONS DECLARATIONS =
 // ===============================
@@ -108,11 +116,17 @@ typedef segment_anim_t digit_segment_animation_t[2];
  * From a technical point of view, negative animation id are just positive ones
  * reversed. It is handled transparently with the appropriate enum values.
  *
- * @param anim_pos The animation position. From 0 to 9.
+ * When step_count is not ANIM_KEYFRAME_COUNT, the position is linearly
+ * interpolated (in 1/256th of pixel) between the two closest keyframes, and
+ * the orientation is the one of the closest keyframe.
+ *
+ * @param anim_pos The animation position. From 0 to step_count - 1.
+ * @param step_count The number of frames of an animation step (at least 2)
  */
 segment_orientation_t
 anim_segment_get(segment_anim_t segment_anim,
                  int anim_pos,
+                 int step_count,
                  digit_size_t digit_size,
                  GPoint* offset);
 
@@ -123,7 +137,7 @@ digit_fixed_segments_t
 anim_get_fixed_segments(digit_anim_t digit_anim);
 
 /** Return true if the given segment is on */
-inline
+static inline
 bool
 anim_get_fixed_segment_state(digit_fixed_segments_t segments,
                              unsigned segment_id)
@@ -131,9 +145,17 @@ anim_get_fixed_segment_state(digit_fixed_segments_t segments,
     return (segments & (1u << segment_id)) != 0;
 }
 
-/** Return the animated segments from a given animation step. */
-const digit_segment_animation_t*
-anim_get_segment_anim(digit_anim_t digit_anim);
+/** Return an animated segment from a given animation step.
+ *
+ * Each animation step can have at most two segment animations. These values
+ * are passed back to anim_segment_get() to get the actual segment placement.
+ *
+ * @param index 0 or 1
+ * @return The segment animation, SA_NOANIM if the step has none at this index
+ */
+segment_anim_t
+anim_get_segment_anim(digit_anim_t digit_anim,
+                      unsigned index);
 
 /** Return the next animation in a sequence.
  * The next animation is the animation step that must follow the given step.
@@ -143,17 +165,19 @@ anim_get_segment_anim(digit_anim_t digit_anim);
 digit_anim_t
 anim_get_next_anim(digit_anim_t digit_anim);
 
-/** Return the next animation to 0.
- * The next animation to 0 is the shortest animation path that return from the
- * given animation step to 0.
+/** Return the previous animation in a sequence.
+ *
+ * This is the animation step to play backward after the given step, when it is
+ * itself played backward. For a static digit, this is the last step of the
+ * transition counting up to it, so counting down from it.
  *
  * @param digit_anim The current animation step
  */
 digit_anim_t
-anim_get_next_quick_anim(digit_anim_t digit_anim);
+anim_get_previous_anim(digit_anim_t digit_anim);
 
 /** Return true if the given animation step is a static digit. */
-inline
+static inline
 bool
 anim_is_static_digit(digit_anim_t digit_anim)
 {
@@ -168,23 +192,12 @@ anim_is_static_digit(digit_anim_t digit_anim)
 bool
 anim_is_multipart(digit_anim_t digit_anim);
 
-/** Determine if an animation step is complete. */
-inline
-bool
-anim_is_complete(digit_anim_t digit_anim,
-                 int step)
-{
-    return (digit_anim < 0)
-           ? true
-           : (step >= 9);
-}
-
 /** Return the number actually displayed by a given animation step.
  *
  * Transition steps will return -1, while static digits will return the
  * appropriate number.
  */
-inline
+static inline
 int
 anim_get_displayed_number(digit_anim_t digit_anim)
 {
@@ -193,21 +206,8 @@ anim_get_displayed_number(digit_anim_t digit_anim)
            : -1;
 }
 
-/** Return the number of steps of an animation step.
- *
- * @return 9 for animation step, 0, for static digit.
- */
-inline
-int
-anim_get_step_count(digit_anim_t digit_anim)
-{
-    return (digit_anim < 0)
-           ? 0
-           : 9;
-}
-
 /** Return the static digit animation step for a given number. */
-inline
+static inline
 digit_anim_t
 anim_get_anim_for_number(int number)
 {
@@ -0,0 +1,170 @@
+/** @file
+ * Build and cache full digit glyphs.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "heap.h"
+#include "utils.h"
+#include "digit_anim.h"
+#include "digit_info.h"
+#include "digit_state.h"
+
+#include "digit_glyphs.h"
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+/** Built glyphs, NULL until requested */
+static
+GBitmap* glyphs[DIGITS_SIZE_COUNT][10];
+
+/** Value of glyphs_use_clock when each glyph was last requested */
+static
+uint32_t glyphs_last_use[DIGITS_SIZE_COUNT][10];
+
+/** Incremented on each glyph request, for each size */
+static
+uint32_t glyphs_use_clock[DIGITS_SIZE_COUNT];
+
+/** Number of glyphs built for each size */
+static
+unsigned glyphs_count[DIGITS_SIZE_COUNT];
+
+/** Keep track of how many times a glyph cache was acquired. */
+static
+unsigned glyphs_load_counter[DIGITS_SIZE_COUNT];
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Compose the glyph of a digit from its static segments. */
+static
+GBitmap*
+build_glyph(digit_size_t size,
+            unsigned number);
+
+/** Release the least recently used glyph of a size */
+static
+void
+evict_glyph(digit_size_t size);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+GBitmap*
+build_glyph(digit_size_t size,
+            unsigned number)
+{
+    GBitmap* result = heap_gbitmap_create_blank(HEAP_SEGMENTS,
+                                                digit_dimensions[size]);
+
+    if (!result) {
+        return NULL;
+    }
+
+    digit_static_images_t images;
+    digit_state_get_static_images(size,
+                                  &images);
+    digit_fixed_segments_t segments =
+        anim_get_fixed_segments(anim_get_anim_for_number(number));
+    GRect clip = GRect(0,
+                       0,
+                       digit_dimensions[size].w,
+                       digit_dimensions[size].h);
+
+    for (int i = 0;
+         i < 7;
+         ++i) {
+        if (anim_get_fixed_segment_state(segments,
+                                         i)) {
+            bitmap_or_bitmap(result,
+                             images.bitmaps[i],
+                             images.rects[i].origin,
+                             clip);
+        }
+    }
+
+    return result;
+}
+
+static
+void
+evict_glyph(digit_size_t size)
+{
+    unsigned oldest = 10;
+
+    for (unsigned number = 0;
+         number < 10;
+         ++number) {
+        if (glyphs[size][number] &&
+            (oldest == 10 ||
+             glyphs_last_use[size][number] < glyphs_last_use[size][oldest])) {
+            oldest = number;
+        }
+    }
+
+    if (oldest < 10) {
+        heap_gbitmap_destroy(HEAP_SEGMENTS,
+                             glyphs[size][oldest]);
+        glyphs[size][oldest] = NULL;
+        --glyphs_count[size];
+    }
+}
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+void
+glyph_load_images(digit_size_t size)
+{
+    ++glyphs_load_counter[size];
+}
+
+void
+glyph_unload_images(digit_size_t size)
+{
+    if (--glyphs_load_counter[size] == 0) {
+        for (unsigned number = 0;
+             number < 10;
+             ++number) {
+            if (glyphs[size][number]) {
+                heap_gbitmap_destroy(HEAP_SEGMENTS,
+                                     glyphs[size][number]);
+                glyphs[size][number] = NULL;
+            }
+        }
+
+        glyphs_count[size] = 0;
+        glyphs_use_clock[size] = 0;
+    }
+}
+
+GBitmap*
+glyph_get_image(digit_size_t size,
+                unsigned number)
+{
+    if (!glyphs[size][number]) {
+        if (glyphs_count[size] >= GLYPH_CACHE_SIZE) {
+            evict_glyph(size);
+        }
+
+        glyphs[size][number] = build_glyph(size,
+                                           number);
+
+        if (glyphs[size][number]) {
+            ++glyphs_count[size];
+        }
+    }
+
+    glyphs_last_use[size][number] = ++glyphs_use_clock[size];
+    return glyphs[size][number];
+}
@@ -0,0 +1,66 @@
+/** @file
+ * Full digit glyphs cache.
+ *
+ * A static digit is made of up to seven segments. Drawing it from a single
+ * pre-composited bitmap instead cost a single blit. Glyphs are built lazily
+ * from the segment images the first time a digit is requested.
+ *
+ * At most GLYPH_CACHE_SIZE glyphs are kept per digit size, enough for the
+ * displayed and target digits of a two digits number; building another one
+ * releases the least recently used.
+ *
+ * Like segment images, glyphs are reference counted per digit size: there must
+ * be as many calls to glyph_unload_images() than to glyph_load_images() for a
+ * given size. The last unloading release all the glyphs built for that size.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_DIGIT_GLYPHS_H
+#define INCL_DIGIT_GLYPHS_H
+
+#include <pebble.h>
+
+#include "digit_info.h"
+
+// ========
+// CONSTS =
+// ========
+
+/** Maximum number of glyphs kept for a digit size */
+#define GLYPH_CACHE_SIZE 4
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Acquire the glyph cache of a digit size.
+ *
+ * No glyph is built until glyph_get_image() is called.
+ */
+void
+glyph_load_images(digit_size_t size);
+
+/** Release the glyph cache of a digit size.
+ *
+ * There must be as many calls to this function as to glyph_load_images().
+ */
+void
+glyph_unload_images(digit_size_t size);
+
+/** Retrieve the glyph of a static digit.
+ *
+ * The glyph is built on the first call, and may be released by a later call for
+ * another digit: it must not be kept. The glyph cache and the segment images
+ * for this size must be loaded.
+ *
+ * @param number The digit to retrieve (0-9)
+ * @return The glyph, with the size of the digit, or NULL if it could not be
+ * built (in which case the digit must be drawn segment by segment)
+ */
+GBitmap*
+glyph_get_image(digit_size_t size,
+                unsigned number);
+
+#endif
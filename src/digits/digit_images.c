@@ -7,8 +7,11 @@
 
 #include <pebble.h>
 
+#include "heap.h"
 #include "utils.h"
 #include "digit_info.h"
+#include "segment_raster.h"
+#include "segment_spans.h"
 
 #include "digit_images.h"
 
@@ -22,6 +25,14 @@ typedef GBitmap* bitmap_array_t[SEGMENTS_ORIENTATION_COUNT];
 /** Array of GSize for all possible orientations. */
 typedef GSize size_array_t[SEGMENTS_ORIENTATION_COUNT];
 
+/** Atlas bitmap of each digit size.
+ *
+ * The vertical and horizontal segment images are sub-bitmaps of the atlas.
+ * Other orientations are only available as spans.
+ */
+static
+GBitmap* segments_atlas[DIGITS_SIZE_COUNT];
+
 static
 bitmap_array_t big_segments;
 
@@ -188,6 +199,138 @@ size_array_t* segments_sizes[DIGITS_SIZE_COUNT] = {
 static
 unsigned segments_images_load_counter[DIGITS_SIZE_COUNT] = { 0, 0};
 
+#ifdef PROCEDURAL_SEGMENTS
+/** Time a rotated segment image of each size was last retrieved */
+static
+time_ms_t rotated_last_use[DIGITS_SIZE_COUNT];
+
+/** True if some rotated segment images of a size are generated */
+static
+bool rotated_loaded[DIGITS_SIZE_COUNT];
+
+/** Timer releasing the unused rotated segment images (NULL if not running) */
+static
+AppTimer* release_timer = NULL;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Return true for orientations that are neither vertical nor horizontal */
+static inline
+bool
+is_rotated(segment_orientation_t orientation)
+{
+    return orientation != SO_VERTICAL && orientation != SO_HORIZONTAL;
+}
+
+/** Destroy the rotated segment images of a size. */
+static
+void
+release_rotated(digit_size_t size);
+
+/** Start the release timer if it is not running. */
+static
+void
+schedule_release(void);
+
+/** Stop the release timer if no rotated segment image is left. */
+static
+void
+cancel_release(void);
+
+/** Release the rotated segment images that were not used during the release
+ * delay, and wait for the next ones. */
+static
+void
+handle_release_timer(void* data);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+release_rotated(digit_size_t size)
+{
+    for (unsigned index = 0;
+         index < SEGMENTS_ORIENTATION_COUNT;
+         ++index) {
+        GBitmap** image = &(*segments_images[size])[index];
+
+        if (is_rotated(index) && *image) {
+            heap_gbitmap_destroy(HEAP_SEGMENTS,
+                                 *image);
+            *image = NULL;
+        }
+    }
+
+    rotated_loaded[size] = false;
+}
+
+static
+void
+schedule_release(void)
+{
+    if (!release_timer) {
+        release_timer = app_timer_register(SEGMENT_RELEASE_DELAY_MS,
+                                           handle_release_timer,
+                                           NULL);
+    }
+}
+
+static
+void
+cancel_release(void)
+{
+    if (!release_timer) {
+        return;
+    }
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        if (rotated_loaded[size]) {
+            return;
+        }
+    }
+
+    app_timer_cancel(release_timer);
+    release_timer = NULL;
+}
+
+static
+void
+handle_release_timer(void* data)
+{
+    release_timer = NULL;
+    time_ms_t now = get_time_ms();
+    time_ms_t next_release = TIME_MS_NEVER;
+
+    for (int size = 0;
+         size < DIGITS_SIZE_COUNT;
+         ++size) {
+        if (!rotated_loaded[size]) {
+            continue;
+        }
+
+        time_ms_t release = rotated_last_use[size] + SEGMENT_RELEASE_DELAY_MS;
+
+        if (release <= now) {
+            release_rotated(size);
+        } else if (release < next_release) {
+            next_release = release;
+        }
+    }
+
+    if (next_release != TIME_MS_NEVER) {
+        release_timer = app_timer_register(next_release - now,
+                                           handle_release_timer,
+                                           NULL);
+    }
+}
+#endif
+
 // ==============================
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
@@ -196,9 +339,38 @@ void
 segment_load_images(digit_size_t size)
 {
     if (segments_images_load_counter[size]++ == 0) {
-        load_bitmap_into_array_from_id(segment_res_ids[size],
-                                       *segments_images[size],
-                                       SEGMENTS_ORIENTATION_COUNT);
+#ifdef PROCEDURAL_SEGMENTS
+        // Rotated orientations are generated when first retrieved
+        (*segments_images[size])[SO_VERTICAL] =
+            segment_raster_create(size,
+                                  SO_VERTICAL,
+                                  (*segments_sizes[size])[SO_VERTICAL]);
+        (*segments_images[size])[SO_HORIZONTAL] =
+            segment_raster_create(size,
+                                  SO_HORIZONTAL,
+                                  (*segments_sizes[size])[SO_HORIZONTAL]);
+#else
+        segments_atlas[size] =
+            heap_gbitmap_create_with_resource(HEAP_SEGMENTS,
+                                              segment_atlas_res_ids[size]);
+        // Vertical then horizontal, top-aligned
+        GSize vertical_size = (*segments_sizes[size])[SO_VERTICAL];
+        GSize horizontal_size = (*segments_sizes[size])[SO_HORIZONTAL];
+        (*segments_images[size])[SO_VERTICAL] =
+            heap_gbitmap_create_as_sub_bitmap(HEAP_SEGMENTS,
+                                              segments_atlas[size],
+                                              GRect(0,
+                                                    0,
+                                                    vertical_size.w,
+                                                    vertical_size.h));
+        (*segments_images[size])[SO_HORIZONTAL] =
+            heap_gbitmap_create_as_sub_bitmap(HEAP_SEGMENTS,
+                                              segments_atlas[size],
+                                              GRect(vertical_size.w,
+                                                    0,
+                                                    horizontal_size.w,
+                                                    horizontal_size.h));
+#endif
     }
 }
 
@@ -209,9 +381,23 @@ segment_unload_images(digit_size_t size)
         for (unsigned index = 0;
              index < SEGMENTS_ORIENTATION_COUNT;
              ++index) {
-            gbitmap_destroy((*segments_images[size])[index]);
-            (*segments_images[size])[index] = NULL;
+            if ((*segments_images[size])[index]) {
+                heap_gbitmap_destroy(HEAP_SEGMENTS,
+                                     (*segments_images[size])[index]);
+                (*segments_images[size])[index] = NULL;
+            }
+        }
+
+        if (segments_atlas[size]) {
+            heap_gbitmap_destroy(HEAP_SEGMENTS,
+                                 segments_atlas[size]);
+            segments_atlas[size] = NULL;
         }
+
+#ifdef PROCEDURAL_SEGMENTS
+        rotated_loaded[size] = false;
+        cancel_release();
+#endif
     }
 }
 
@@ -220,8 +406,40 @@ segment_get_image(digit_size_t size,
                   segment_orientation_t orientation,
                   GSize* bitmap_size)
 {
-    GBitmap* result = (*segments_images[size])[orientation];
+    GBitmap** image = &(*segments_images[size])[orientation];
     *bitmap_size = (*segments_sizes[size])[orientation];
-    return result;
+
+#ifdef PROCEDURAL_SEGMENTS
+    if (is_rotated(orientation) && segments_images_load_counter[size]) {
+        if (!*image) {
+            *image = segment_raster_create(size,
+                                           orientation,
+                                           *bitmap_size);
+            rotated_loaded[size] = true;
+        }
+
+        rotated_last_use[size] = get_time_ms();
+        schedule_release();
+    }
+#endif
+
+    return *image;
 }
 
+GSize
+segment_get_size(digit_size_t size,
+                 segment_orientation_t orientation)
+{
+    return (*segments_sizes[size])[orientation];
+}
+
+const segment_spans_t*
+segment_get_spans(digit_size_t size,
+                  segment_orientation_t orientation)
+{
+#ifdef PROCEDURAL_SEGMENTS
+    return NULL;
+#else
+    return &segment_spans[size][orientation];
+#endif
+}
@@ -4,6 +4,17 @@
  * Digit images only contains a single segment at various orientation. Their
  * position and animation is handled in digitlayer and digit_anim.
  *
+ * Moving segments are drawn from spans (see segment_spans.h), and only the
+ * vertical and horizontal segment images, used to compose static digits, are
+ * loaded as sub-bitmaps of a single atlas resource per digit size.
+ * When built with PROCEDURAL_SEGMENTS defined (see the --procedural-segments
+ * configure option), all the orientations are instead generated as bitmaps by
+ * segment_raster, and no span is available. Only the vertical and horizontal
+ * segments are generated when loading; other orientations are generated the
+ * first time they are retrieved, and released once they have not been used for
+ * a while (see SEGMENT_RELEASE_DELAY_MS), so digits that are not animated
+ * do not keep them in memory.
+ *
  * Loading and unloading keep a reference counter, so the corresponding
  * functions can be called multiple time without issues, as long as there is no
  * more calls to segment_unload_images() than to segment_load_images() for a
@@ -20,6 +31,21 @@
 #include <pebble.h>
 
 #include "digit_info.h"
+#include "segment_spans.h"
+
+// ========
+// CONSTS =
+// ========
+
+/** Delay before releasing unused rotated segment images, in milliseconds.
+ *
+ * Set at configure time with --segment-release-delay. The default is a bit
+ * more than a minute, so animating on every minute change does not generate
+ * them again each time.
+ */
+#ifndef SEGMENT_RELEASE_DELAY_MS
+#define SEGMENT_RELEASE_DELAY_MS 70000
+#endif
 
 // ===============================
 // PUBLIC FUNCTIONS DECLARATIONS =
@@ -43,14 +69,32 @@ segment_unload_images(digit_size_t size);
 /** Retrieve a segment image.
  *
  * Before calling this function an appropriate call to segment_load_images()
- * must have been done.
+ * must have been done. Use segment_get_size() when only the size is needed:
+ * this may generate the image.
  *
  * @param bitmap_size A pointer to get the size of the bitmap. Can not be NULL
+ * @return The segment bitmap. NULL for orientations only available as spans
+ * (see segment_get_spans()), or if it could not be generated; bitmap_size is
+ * set in any case.
  */
 GBitmap*
 segment_get_image(digit_size_t size,
                   segment_orientation_t orientation,
                   GSize* bitmap_size);
 
+/** Return the size of a segment image, without retrieving it. */
+GSize
+segment_get_size(digit_size_t size,
+                 segment_orientation_t orientation);
+
+/** Retrieve the spans of a segment.
+ *
+ * @return The segment spans, or NULL if segments are only available as
+ * bitmaps.
+ */
+const segment_spans_t*
+segment_get_spans(digit_size_t size,
+                  segment_orientation_t orientation);
+
 #endif
 
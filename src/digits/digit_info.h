@@ -71,6 +71,16 @@ typedef enum {
     FAST_MERGED
 } animation_speed_t;
 
+/** Placement of a segment, relative to the digit top-left corner.
+ *
+ * Placement tables use this instead of GPoint: all placements are positive
+ * and below 256, so they take half the space.
+ */
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+} segment_offset_t;
+
 // =========
 // EXTERNS =
 // =========
@@ -82,12 +92,18 @@ typedef enum {
 extern
 const GSize digit_dimensions[];
 
-/** Image resource identifiers for segments.
- * Each value correspond to an enum value of digit_size_t, and point to an array
- * where each value correspond to an enum value of segment_orientation_t
+#ifndef PROCEDURAL_SEGMENTS
+/** Segment atlas image resource identifiers.
+ * Each value correspond to an enum value of digit_size_t. An atlas holds the
+ * vertical and horizontal segments of a size, side by side and top-aligned
+ * (built by extra/atlas/makeatlas.py). The rotated orientations are not in the
+ * atlas: moving segments are drawn from their spans (see segment_spans.h).
+ *
+ * Not available when segments are generated (PROCEDURAL_SEGMENTS).
  */
 extern
-const ResourceId* const segment_res_ids[DIGITS_SIZE_COUNT];
+const ResourceId segment_atlas_res_ids[DIGITS_SIZE_COUNT];
+#endif
 
 /** Spacing between digits for each digit size. */
 extern
@@ -0,0 +1,78 @@
+/** @file
+ * Shortest transitions between digits.
+ *
+ * From a static digit, an animation can either move to the next digit or take
+ * the shortcut to 0 (with quick wrap), or play one of these transitions
+ * backward. The route table gives, for every pair of digits, the first
+ * animation step of the cheapest path from one to the other; once a static
+ * digit is reached on the way, the table is looked up again.
+ *
+ * Without quick wrap, the cheapest path counts up or down. Looking it up again
+ * on every digit matters when a transition is interrupted: an animation that
+ * was heading elsewhere may reach a digit from which the other direction is
+ * shorter.
+ *
+ * The table is generated from the animation steps of digit_anim.c by
+ * extra/routes/makeroutes.py when configuring, in digit_routes.auto.c.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_DIGIT_ROUTES_H
+#define INCL_DIGIT_ROUTES_H
+
+#include <pebble.h>
+
+#include "digit_anim.h"
+
+// =======
+// TYPES =
+// =======
+
+/** Transitions a path can take */
+typedef enum {
+    /** Count up or down, one digit at a time */
+    ROUTE_COUNTING,
+    /** Also take the shortcuts to 0 */
+    ROUTE_QUICK_WRAP,
+    ROUTE_EDGES_COUNT
+} route_edges_t;
+
+/** How the cost of a path is measured */
+typedef enum {
+    /** Every animation step costs the same number of frames */
+    ROUTE_COST_STEPS,
+    /** Steps of two-step transitions are played twice faster (FAST_MERGED
+     * speed)
+     */
+    ROUTE_COST_MERGED,
+    ROUTE_COST_COUNT
+} route_cost_t;
+
+// ========
+// CONSTS =
+// ========
+
+/** Number of digits in the route table */
+#define DIGIT_ROUTE_COUNT 10
+
+/** Flag set on a route step that is played backward */
+#define ROUTE_REVERSE 0x40
+
+// =========
+// EXTERNS =
+// =========
+
+/** First animation step (digit_anim_t) of the cheapest path between two
+ * digits, indexed by allowed transitions, cost model, source digit and target
+ * digit.
+ *
+ * Steps to play backward are combined with ROUTE_REVERSE; playing them
+ * backward continues with anim_get_previous_anim().
+ */
+extern
+const int8_t digit_routes[ROUTE_EDGES_COUNT][ROUTE_COST_COUNT]
+                        [DIGIT_ROUTE_COUNT][DIGIT_ROUTE_COUNT];
+
+#endif
@@ -0,0 +1,1051 @@
+/** @file
+ * Implementation of the digit state and animation logic.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "heap.h"
+#include "utils.h"
+#include "digit_anim.h"
+#include "digit_glyphs.h"
+#include "digit_images.h"
+#include "digit_info.h"
+#include "digit_routes.h"
+
+#include "digit_state.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Offsets to draw the 7 static segments of a digit. */
+typedef const segment_offset_t static_segment_offset_t[7];
+
+/** A segment placed in a digit */
+typedef struct {
+    GBitmap* bitmap;
+    /** If not NULL, the segment is drawn from these spans instead of bitmap */
+    const segment_spans_t* spans;
+    /** Placement, relative to the digit top-left corner */
+    GRect rect;
+} segment_placement_t;
+
+/** A position in a transition, while it is compiled */
+typedef struct {
+    digit_anim_t anim;
+    int position;
+    /** The animation step is played backward */
+    bool reverse;
+    /** Leave the static digit in the direction of reverse instead of taking
+     * the route */
+    bool forced;
+} anim_cursor_t;
+
+// ===============
+// PRIVATE CONST =
+// ===============
+
+/** Placement of the segments to display each digit size. */
+static
+static_segment_offset_t static_segment_offset[DIGITS_SIZE_COUNT] = {
+    {
+        {6, 0},  {0, 6},   {37, 6}, {6, 37},
+        {0, 43}, {37, 43}, {6, 74}
+    }, {
+        {5, 0},  {0, 5},   {35, 5}, {5, 35},
+        {0, 40}, {35, 40}, {5, 70}
+    }, {
+        {2, 0},  {0, 3},   {13, 3}, {2, 15},
+        {0, 18}, {13, 18}, {2, 30}
+    }
+};
+
+/** Duration of an animation step at fast speeds, in milliseconds.
+ *
+ * It is divided between the frames of the step (see
+ * digit_state_set_step_count()). Each compiled frame is displayed for a
+ * multiple of that frame time; slow speeds wait twice as long between frames.
+ */
+static
+const uint16_t step_duration_ms = 900;
+
+/** Orientation of static segments. (shared by all digits size) */
+static
+const uint8_t static_segment_orientation[7] = {
+    SO_HORIZONTAL, SO_VERTICAL, SO_VERTICAL,
+    SO_HORIZONTAL, SO_VERTICAL, SO_VERTICAL,
+    SO_HORIZONTAL
+};
+
+// Routes flag steps played backward with a bit no animation step uses
+STATIC_ASSERT(DA_8_TO_0 < ROUTE_REVERSE,
+              route_reverse_is_free);
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Retrieve all the segments to draw for the current frame.
+ *
+ * Static digits are drawn from their cached glyph when available.
+ *
+ * @param placements Receive up to 9 placements (7 fixed, 2 moving)
+ * @return The number of placements
+ */
+static
+unsigned
+get_placements(const digit_state_t* state,
+               const digit_static_images_t* images,
+               segment_placement_t placements[9]);
+
+/** Compose the fixed segments of the current frame in the background bitmap.
+ *
+ * On allocation failure the background is left unused, and fixed segments are
+ * drawn one by one.
+ */
+static
+void
+update_background(digit_state_t* state);
+
+/** Draw a span-encoded segment with horizontal fills.
+ *
+ * @param origin Top-left corner of the segment
+ */
+static
+void
+draw_spans(const segment_spans_t* spans,
+           GPoint origin,
+           GContext* ctx);
+
+/** Draw a span-encoded segment into an offscreen bitmap.
+ *
+ * @param origin Top-left corner of the segment in the bitmap
+ * @param clip Only this area of the bitmap is drawn
+ */
+static
+void
+draw_spans_in_bitmap(const segment_spans_t* spans,
+                     GPoint origin,
+                     GRect clip,
+                     GBitmap* target);
+
+/** Return the area covered by the moving segments of a frame. */
+static
+GRect
+get_moving_rect(digit_size_t size,
+                const digit_frame_t* frame);
+
+/** Return the area covered by a set of fixed segments. */
+static
+GRect
+get_fixed_rect(digit_size_t size,
+               digit_fixed_segments_t segments);
+
+/** Return the time a frame of an animation step is displayed, in frame_ms
+ * units.
+ */
+static
+uint8_t
+get_frame_delay(const digit_state_t* state,
+                digit_anim_t anim);
+
+/** Return the first animation step to leave a static digit toward the target
+ * number.
+ *
+ * This is the cheapest route from the route table. Without quick wrap, digits
+ * are counted one by one, up or down. With it, the shortcuts to 0 are the ones
+ * listed by extra/routes/makeroutes.py (QUICK_NEXT), the source of truth for
+ * the quick wrap behaviour of digit_layer_set_quick_wrap().
+ *
+ * @param reverse Set if the returned step must be played backward
+ */
+static
+digit_anim_t
+get_route_step(const digit_state_t* state,
+               digit_anim_t anim,
+               bool* reverse);
+
+/** Resolve everything needed to display an animation position in a frame. */
+static
+void
+fill_frame(const digit_state_t* state,
+           digit_anim_t anim,
+           int position,
+           digit_frame_t* frame);
+
+/** Move an animation position by one frame, in its direction.
+ *
+ * @return true if the target number is reached
+ */
+static
+bool
+step_position(const digit_state_t* state,
+              anim_cursor_t* cursor);
+
+/** Return the number of frames from a position to the target number.
+ *
+ * @param duration Receive the time until the last frame is displayed, in
+ * frame_ms units
+ */
+static
+unsigned
+count_frames(const digit_state_t* state,
+             anim_cursor_t cursor,
+             unsigned* duration);
+
+/** Choose the direction of a transition to the target number.
+ *
+ * The animation step of the cursor is either played to its end, or backward to
+ * its start, whichever reaches the target number in fewer frames. From a
+ * static digit, the route is taken with quick wrap; without it, counting up
+ * and down are compared.
+ *
+ * @param cursor The starting position, its direction is updated
+ * @param duration See count_frames()
+ * @return The number of frames of the transition
+ */
+static
+unsigned
+choose_direction(const digit_state_t* state,
+                 anim_cursor_t* cursor,
+                 unsigned* duration);
+
+/** Compile the transition from the displayed frame to the target number.
+ *
+ * The frames are stored in state->frames. If they can not be allocated, the
+ * target number is displayed immediately.
+ *
+ * @return true if the target number was displayed immediately, and the digit
+ * must be redrawn entirely
+ */
+static
+bool
+compile_transition(digit_state_t* state);
+
+/** Release the compiled transition frames. */
+static
+void
+release_frames(digit_state_t* state);
+
+/** Release the background composed for the animation steps. */
+static
+void
+release_background(digit_state_t* state);
+
+/** Display a frame of the compiled transition.
+ *
+ * The frames before it are dropped; only the change from the displayed frame
+ * to the new one is redrawn.
+ *
+ * @param index Index of the frame in state->frames
+ * @param dirty_rect See digit_state_animate()
+ */
+static
+void
+show_frame(digit_state_t* state,
+           unsigned index,
+           GRect* dirty_rect);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+unsigned
+get_placements(const digit_state_t* state,
+               const digit_static_images_t* images,
+               segment_placement_t placements[9])
+{
+    unsigned count = 0;
+    const digit_frame_t* frame = &state->frame;
+
+    if (anim_is_static_digit(frame->anim)) {
+        GBitmap* glyph =
+            glyph_get_image(state->size,
+                            anim_get_displayed_number(frame->anim));
+
+        if (glyph) {
+            placements[0].bitmap = glyph;
+            placements[0].spans = NULL;
+            placements[0].rect = GRect(0,
+                                       0,
+                                       digit_dimensions[state->size].w,
+                                       digit_dimensions[state->size].h);
+            return 1;
+        }
+    }
+
+    if (state->background &&
+        state->background_anim == frame->anim) {
+        placements[0].bitmap = state->background;
+        placements[0].spans = NULL;
+        placements[0].rect = GRect(0,
+                                   0,
+                                   digit_dimensions[state->size].w,
+                                   digit_dimensions[state->size].h);
+        ++count;
+    } else {
+        for (int i = 0;
+             i < 7;
+             ++i) {
+            if (!anim_get_fixed_segment_state(frame->fixed_segments,
+                                              i)) {
+                continue;
+            }
+
+            placements[count].bitmap = images->bitmaps[i];
+            placements[count].spans = NULL;
+            placements[count].rect = images->rects[i];
+            ++count;
+        }
+    }
+
+    for (int i = 0;
+         i < 2;
+         ++i) {
+        const digit_frame_segment_t* segment = &frame->moving_segments[i];
+
+        if (segment->orientation == SEGMENTS_ORIENTATION_COUNT) {
+            continue;
+        }
+
+        placements[count].rect.origin = GPoint(segment->x,
+                                               segment->y);
+        placements[count].bitmap =
+            segment_get_image(state->size,
+                              segment->orientation,
+                              &placements[count].rect.size);
+        placements[count].spans = segment_get_spans(state->size,
+                                                    segment->orientation);
+        ++count;
+    }
+
+    return count;
+}
+
+static
+void
+update_background(digit_state_t* state)
+{
+    GRect digit_rect = GRect(0,
+                             0,
+                             digit_dimensions[state->size].w,
+                             digit_dimensions[state->size].h);
+
+    if (!state->background) {
+        state->background = heap_gbitmap_create_blank(HEAP_DIGITS,
+                                                      digit_rect.size);
+
+        if (!state->background) {
+            return;
+        }
+    }
+
+    digit_static_images_t images;
+    digit_state_get_static_images(state->size,
+                                  &images);
+    bitmap_clear_rect(state->background,
+                      digit_rect);
+
+    for (int i = 0;
+         i < 7;
+         ++i) {
+        if (anim_get_fixed_segment_state(state->frame.fixed_segments,
+                                         i)) {
+            bitmap_or_bitmap(state->background,
+                             images.bitmaps[i],
+                             images.rects[i].origin,
+                             digit_rect);
+        }
+    }
+
+    state->background_anim = state->frame.anim;
+}
+
+static
+void
+draw_spans(const segment_spans_t* spans,
+           GPoint origin,
+           GContext* ctx)
+{
+    graphics_context_set_fill_color(ctx,
+                                    GColorWhite);
+
+    for (unsigned i = 0;
+         i < spans->count;
+         ++i) {
+        const segment_span_t* span = &spans->spans[i];
+        graphics_fill_rect(ctx,
+                           GRect(origin.x + segment_span_get_x(spans,
+                                                               span),
+                                 origin.y + span->y,
+                                 span->length,
+                                 1),
+                           0,
+                           GCornerNone);
+    }
+}
+
+static
+void
+draw_spans_in_bitmap(const segment_spans_t* spans,
+                     GPoint origin,
+                     GRect clip,
+                     GBitmap* target)
+{
+    for (unsigned i = 0;
+         i < spans->count;
+         ++i) {
+        const segment_span_t* span = &spans->spans[i];
+        bitmap_fill_rect(target,
+                         rect_intersection(GRect(origin.x +
+                                                 segment_span_get_x(spans,
+                                                                    span),
+                                                 origin.y + span->y,
+                                                 span->length,
+                                                 1),
+                                           clip));
+    }
+}
+
+static
+GRect
+get_moving_rect(digit_size_t size,
+                const digit_frame_t* frame)
+{
+    GRect result = GRectZero;
+
+    for (int i = 0;
+         i < 2;
+         ++i) {
+        const digit_frame_segment_t* segment = &frame->moving_segments[i];
+
+        if (segment->orientation == SEGMENTS_ORIENTATION_COUNT) {
+            continue;
+        }
+
+        GRect segment_rect;
+        segment_rect.origin = GPoint(segment->x,
+                                     segment->y);
+        segment_rect.size = segment_get_size(size,
+                                             segment->orientation);
+        result = rect_union(result,
+                            segment_rect);
+    }
+
+    return result;
+}
+
+static
+GRect
+get_fixed_rect(digit_size_t size,
+               digit_fixed_segments_t segments)
+{
+    GRect result = GRectZero;
+
+    for (int i = 0;
+         i < 7;
+         ++i) {
+        if (!anim_get_fixed_segment_state(segments,
+                                          i)) {
+            continue;
+        }
+
+        const segment_offset_t* offset = &static_segment_offset[size][i];
+        GRect segment_rect;
+        segment_rect.origin = GPoint(offset->x,
+                                     offset->y);
+        segment_rect.size = segment_get_size(size,
+                                             static_segment_orientation[i]);
+        result = rect_union(result,
+                            segment_rect);
+    }
+
+    return result;
+}
+
+static
+uint8_t
+get_frame_delay(const digit_state_t* state,
+                digit_anim_t anim)
+{
+    switch (state->animate_speed) {
+    case SLOW_SEPARATE:
+        return 2;
+
+    case SLOW_MERGED:
+        // Multi-step transition run at full speed
+        return anim_is_multipart(anim)
+               ? 1
+               : 2;
+
+    default:
+        return 1;
+    }
+}
+
+static
+digit_anim_t
+get_route_step(const digit_state_t* state,
+               digit_anim_t anim,
+               bool* reverse)
+{
+    route_edges_t edges = state->quick_wrap
+                          ? ROUTE_QUICK_WRAP
+                          : ROUTE_COUNTING;
+    route_cost_t cost = state->animate_speed == FAST_MERGED
+                        ? ROUTE_COST_MERGED
+                        : ROUTE_COST_STEPS;
+    int8_t step = digit_routes[edges][cost][anim_get_displayed_number(anim)]
+                  [state->target_number];
+    *reverse = step > 0 && (step & ROUTE_REVERSE);
+    return *reverse
+           ? step & ~ROUTE_REVERSE
+           : step;
+}
+
+static
+void
+fill_frame(const digit_state_t* state,
+           digit_anim_t anim,
+           int position,
+           digit_frame_t* frame)
+{
+    frame->anim = anim;
+    frame->position = position;
+    frame->fixed_segments = anim_get_fixed_segments(anim);
+    frame->delay = get_frame_delay(state,
+                                   anim);
+
+    for (int i = 0;
+         i < 2;
+         ++i) {
+        digit_frame_segment_t* segment = &frame->moving_segments[i];
+        segment_anim_t segment_anim = anim_get_segment_anim(anim,
+                                                            i);
+
+        if (segment_anim == SA_NOANIM) {
+            segment->orientation = SEGMENTS_ORIENTATION_COUNT;
+            continue;
+        }
+
+        GPoint offset;
+        segment->orientation = anim_segment_get(segment_anim,
+                                                position,
+                                                state->step_count,
+                                                state->size,
+                                                &offset);
+        segment->x = offset.x;
+        segment->y = offset.y;
+    }
+}
+
+static
+bool
+step_position(const digit_state_t* state,
+              anim_cursor_t* cursor)
+{
+    if (anim_is_static_digit(cursor->anim)) {
+        // Leaving a static digit, take the route to the target. The first
+        // frame of a step looks like the digit it leaves, so it is skipped.
+        if (cursor->forced) {
+            cursor->anim = cursor->reverse
+                           ? anim_get_previous_anim(cursor->anim)
+                           : anim_get_next_anim(cursor->anim);
+            cursor->forced = false;
+        } else {
+            cursor->anim = get_route_step(state,
+                                          cursor->anim,
+                                          &cursor->reverse);
+        }
+
+        cursor->position = cursor->reverse
+                           ? state->step_count - 2
+                           : 1;
+        return false;
+    }
+
+    // Twice faster for two-step transitions
+    int stride = (state->animate_speed == FAST_MERGED &&
+                  anim_is_multipart(cursor->anim))
+                 ? 2
+                 : 1;
+
+    // Transition steps just continue until they reach a digit
+    if (cursor->reverse) {
+        cursor->position -= stride;
+
+        if (cursor->position >= 0) {
+            return false;
+        }
+
+        cursor->position += state->step_count;
+        cursor->anim = anim_get_previous_anim(cursor->anim);
+    } else {
+        cursor->position += stride;
+
+        if (cursor->position < state->step_count) {
+            return false;
+        }
+
+        cursor->position -= state->step_count;
+        cursor->anim = anim_get_next_anim(cursor->anim);
+    }
+
+    if (anim_is_static_digit(cursor->anim)) {
+        cursor->position = 0;
+        return anim_get_displayed_number(cursor->anim) ==
+               ((int) state->target_number);
+    }
+
+    return false;
+}
+
+static
+unsigned
+count_frames(const digit_state_t* state,
+             anim_cursor_t cursor,
+             unsigned* duration)
+{
+    unsigned count = 1;
+    // The last frame is displayed once all the others are over
+    *duration = get_frame_delay(state,
+                                cursor.anim);
+
+    while (!step_position(state,
+                          &cursor)) {
+        *duration += get_frame_delay(state,
+                                     cursor.anim);
+        ++count;
+    }
+
+    return count;
+}
+
+static
+unsigned
+choose_direction(const digit_state_t* state,
+                 anim_cursor_t* cursor,
+                 unsigned* duration)
+{
+    bool from_static = anim_is_static_digit(cursor->anim);
+    cursor->reverse = false;
+    // Without quick wrap, counting up and down are compared frame by frame:
+    // the route table does not know the exact frame count of each step
+    cursor->forced = from_static && !state->quick_wrap;
+    unsigned count = count_frames(state,
+                                  *cursor,
+                                  duration);
+
+    // With quick wrap, the route already goes the shortest way
+    if (from_static && state->quick_wrap) {
+        return count;
+    }
+
+    anim_cursor_t reverse_cursor = *cursor;
+    reverse_cursor.reverse = true;
+    unsigned reverse_duration;
+    unsigned reverse_count = count_frames(state,
+                                          reverse_cursor,
+                                          &reverse_duration);
+
+    // Play forward unless going back is shorter
+    if (reverse_count < count) {
+        *cursor = reverse_cursor;
+        *duration = reverse_duration;
+        return reverse_count;
+    }
+
+    return count;
+}
+
+static
+bool
+compile_transition(digit_state_t* state)
+{
+    release_frames(state);
+    anim_cursor_t cursor = {state->frame.anim,
+                            state->frame.position,
+                            false,
+                            false};
+
+    if (anim_get_displayed_number(cursor.anim) ==
+        ((int) state->target_number)) {
+        return false;
+    }
+
+    unsigned duration;
+    unsigned count = choose_direction(state,
+                                      &cursor,
+                                      &duration);
+    state->frames = heap_malloc(HEAP_DIGITS,
+                                count * sizeof(digit_frame_t));
+
+    if (!state->frames) {
+        digit_state_kill_anim(state);
+        return true;
+    }
+
+    // The displayed frame delay follow the current speed as well
+    fill_frame(state,
+               cursor.anim,
+               cursor.position,
+               &state->frame);
+
+    for (unsigned i = 0;
+         i < count;
+         ++i) {
+        step_position(state,
+                      &cursor);
+        fill_frame(state,
+                   cursor.anim,
+                   cursor.position,
+                   &state->frames[i]);
+    }
+
+    state->frames_count = count;
+    state->frames_index = 0;
+    return false;
+}
+
+static
+void
+release_frames(digit_state_t* state)
+{
+    if (state->frames) {
+        heap_free(HEAP_DIGITS,
+                  state->frames);
+        state->frames = NULL;
+    }
+
+    state->frames_count = 0;
+    state->frames_index = 0;
+}
+
+static
+void
+release_background(digit_state_t* state)
+{
+    if (state->background) {
+        heap_gbitmap_destroy(HEAP_DIGITS,
+                             state->background);
+        state->background = NULL;
+    }
+
+    state->background_anim = 0;
+}
+
+static
+void
+show_frame(digit_state_t* state,
+           unsigned index,
+           GRect* dirty_rect)
+{
+    digit_frame_t previous_frame = state->frame;
+    state->frame = state->frames[index];
+    state->frames_index = index + 1;
+
+    if (state->frames_index == state->frames_count) {
+        // The transition ends on a static digit, drawn from its glyph
+        release_frames(state);
+        release_background(state);
+    }
+
+    GRect changed_rect = rect_union(get_moving_rect(state->size,
+                                                    &previous_frame),
+                                    get_moving_rect(state->size,
+                                                    &state->frame));
+
+    if (previous_frame.anim != state->frame.anim) {
+        if (!anim_is_static_digit(state->frame.anim)) {
+            update_background(state);
+        }
+
+        // Segments switching between moving and fixed between two steps
+        changed_rect = rect_union(changed_rect,
+                                  get_fixed_rect(state->size,
+                                                 previous_frame.fixed_segments ^
+                                                 state->frame.fixed_segments));
+    }
+
+    *dirty_rect = rect_union(*dirty_rect,
+                             changed_rect);
+}
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+void
+digit_state_init(digit_state_t* state,
+                 digit_size_t size)
+{
+    state->size = size;
+    state->target_number = 0;
+    state->frames = NULL;
+    state->frames_count = 0;
+    state->frames_index = 0;
+    state->animate_speed = FAST_MERGED;
+    state->quick_wrap = false;
+    state->step_count = ANIM_KEYFRAME_COUNT;
+    state->frame_ms = step_duration_ms / ANIM_KEYFRAME_COUNT;
+    state->next_frame = 0;
+    state->background = NULL;
+    state->background_anim = 0;
+    fill_frame(state,
+               DA_0,
+               0,
+               &state->frame);
+}
+
+void
+digit_state_deinit(digit_state_t* state)
+{
+    release_frames(state);
+    release_background(state);
+}
+
+bool
+digit_state_set_number(digit_state_t* state,
+                       unsigned target_number,
+                       bool animate)
+{
+    if (state->target_number == target_number) {
+        return false;
+    }
+
+    state->target_number = target_number % 10;
+
+    // If we are already in an animation, keep going
+    if (!animate && anim_is_static_digit(state->frame.anim)) {
+        digit_state_kill_anim(state);
+        return true;
+    }
+
+    return compile_transition(state);
+}
+
+void
+digit_state_kill_anim(digit_state_t* state)
+{
+    release_frames(state);
+    release_background(state);
+    fill_frame(state,
+               anim_get_anim_for_number(state->target_number),
+               0,
+               &state->frame);
+    state->next_frame = 0;
+}
+
+bool
+digit_state_set_quick_wrap(digit_state_t* state,
+                           bool quick_wrap)
+{
+    state->quick_wrap = quick_wrap;
+
+    if (state->frames) {
+        return compile_transition(state);
+    }
+
+    return false;
+}
+
+bool
+digit_state_set_animate_speed(digit_state_t* state,
+                              animation_speed_t speed)
+{
+    state->animate_speed = speed;
+
+    if (state->frames) {
+        return compile_transition(state);
+    }
+
+    return false;
+}
+
+bool
+digit_state_set_step_count(digit_state_t* state,
+                           unsigned step_count)
+{
+    if (step_count < 2) {
+        step_count = 2;
+    }
+
+    if (step_count == state->step_count) {
+        return false;
+    }
+
+    state->step_count = step_count;
+    state->frame_ms = step_duration_ms / step_count;
+
+    if (state->frames) {
+        // Positions of the old step count are meaningless with the new one
+        fill_frame(state,
+                   state->frame.anim,
+                   0,
+                   &state->frame);
+        return compile_transition(state);
+    }
+
+    return false;
+}
+
+uint32_t
+digit_state_get_transition_ms(const digit_state_t* state,
+                              unsigned target_number)
+{
+    target_number %= 10;
+
+    if (target_number == state->target_number) {
+        return 0;
+    }
+
+    digit_state_t probe = *state;
+    probe.target_number = target_number;
+    digit_anim_t anim = anim_get_anim_for_number(state->target_number);
+    anim_cursor_t cursor = {anim, 0, false, false};
+    unsigned duration;
+    choose_direction(&probe,
+                     &cursor,
+                     &duration);
+    return duration * state->frame_ms;
+}
+
+bool
+digit_state_animate(digit_state_t* state,
+                    time_ms_t now,
+                    time_ms_t* next_frame,
+                    GRect* dirty_rect)
+{
+    // Only animate if needed
+    if (!state->frames) {
+        state->next_frame = 0;
+        return false;
+    }
+
+    if (state->next_frame == 0) {
+        // First frame of a new animation
+        state->next_frame = now + state->frame.delay * state->frame_ms;
+    } else if (now >= state->next_frame) {
+        // Deadlines follow the nominal schedule of the transition instead of
+        // the actual wakeup time. If we are late, the frames whose display
+        // time is already over are dropped, so the transition still ends on
+        // time; the last frame is never dropped.
+        unsigned index = state->frames_index;
+        time_ms_t frame_start = state->next_frame;
+
+        while (index + 1 < state->frames_count) {
+            time_ms_t frame_end = frame_start +
+                                  state->frames[index].delay * state->frame_ms;
+
+            if (now < frame_end) {
+                break;
+            }
+
+            frame_start = frame_end;
+            ++index;
+        }
+
+        show_frame(state,
+                   index,
+                   dirty_rect);
+
+        if (!state->frames) {
+            state->next_frame = 0;
+            return false;
+        }
+
+        state->next_frame = frame_start + state->frame.delay * state->frame_ms;
+    }
+
+    if (state->next_frame < *next_frame) {
+        *next_frame = state->next_frame;
+    }
+
+    return true;
+}
+
+void
+digit_state_get_static_images(digit_size_t size,
+                              digit_static_images_t* images)
+{
+    images->size = size;
+
+    for (int i = 0;
+         i < 7;
+         ++i) {
+        const segment_offset_t* offset = &static_segment_offset[size][i];
+        images->rects[i].origin = GPoint(offset->x,
+                                         offset->y);
+        images->bitmaps[i] =
+            segment_get_image(size,
+                              static_segment_orientation[i],
+                              &images->rects[i].size);
+    }
+}
+
+void
+digit_state_draw(const digit_state_t* state,
+                 const digit_static_images_t* images,
+                 GPoint offset,
+                 GContext* ctx)
+{
+    segment_placement_t placements[9];
+    unsigned count = get_placements(state,
+                                    images,
+                                    placements);
+
+    for (unsigned i = 0;
+         i < count;
+         ++i) {
+        GRect draw_rect = placements[i].rect;
+        draw_rect.origin.x += offset.x;
+        draw_rect.origin.y += offset.y;
+
+        if (placements[i].spans) {
+            draw_spans(placements[i].spans,
+                       draw_rect.origin,
+                       ctx);
+        } else {
+            graphics_draw_bitmap_in_rect(ctx,
+                                         placements[i].bitmap,
+                                         draw_rect);
+        }
+    }
+}
+
+void
+digit_state_draw_in_bitmap(const digit_state_t* state,
+                           const digit_static_images_t* images,
+                           GPoint offset,
+                           GRect clip,
+                           GBitmap* target)
+{
+    segment_placement_t placements[9];
+    unsigned count = get_placements(state,
+                                    images,
+                                    placements);
+
+    for (unsigned i = 0;
+         i < count;
+         ++i) {
+        GPoint origin = placements[i].rect.origin;
+        origin.x += offset.x;
+        origin.y += offset.y;
+
+        if (placements[i].spans) {
+            draw_spans_in_bitmap(placements[i].spans,
+                                 origin,
+                                 clip,
+                                 target);
+        } else {
+            bitmap_or_bitmap(target,
+                             placements[i].bitmap,
+                             origin,
+                             clip);
+        }
+    }
+}
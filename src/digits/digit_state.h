@@ -0,0 +1,226 @@
+/** @file
+ * Digit state.
+ *
+ * State and animation logic of a single animated digit, independent from any
+ * layer. DigitLayer wraps a single digit state in its own layer, while
+ * NumberLayer keeps all its digits states and draws them in a single update
+ * proc.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_DIGIT_STATE_H
+#define INCL_DIGIT_STATE_H
+
+#include <pebble.h>
+
+#include "utils.h"
+#include "digit_anim.h"
+#include "digit_info.h"
+
+// =======
+// TYPES =
+// =======
+
+/** A moving segment of an animation frame */
+typedef struct {
+    /** Orientation, SEGMENTS_ORIENTATION_COUNT if the segment is not used */
+    uint8_t orientation;
+    /** Placement, relative to the digit top-left corner */
+    uint8_t x;
+    uint8_t y;
+} digit_frame_segment_t;
+
+/** A single frame of a compiled transition.
+ *
+ * Everything needed to draw the frame is resolved when the transition is
+ * compiled, so playing it back needs no animation table lookup.
+ */
+typedef struct {
+    /** Animation step of the frame (a static digit on the last frame) */
+    int8_t anim;
+    /** Position in the animation step (always < step_count) */
+    uint8_t position;
+    digit_fixed_segments_t fixed_segments;
+    /** Time this frame is displayed, in frame_ms units */
+    uint8_t delay;
+    digit_frame_segment_t moving_segments[2];
+} digit_frame_t;
+
+/** State of an animated digit. */
+typedef struct {
+    digit_size_t size;
+    /** Target number to display (set by digit_state_set_number()) */
+    unsigned target_number;
+    /** Currently displayed frame */
+    digit_frame_t frame;
+    /** Remaining frames of the current transition (NULL if not animated) */
+    digit_frame_t* frames;
+    uint16_t frames_count;
+    /** Index of the next frame to display in frames */
+    uint16_t frames_index;
+
+    animation_speed_t animate_speed;
+    bool quick_wrap;
+    /** Number of frames of an animation step */
+    uint8_t step_count;
+    /** Display time of a frame at fast speeds, in milliseconds */
+    uint16_t frame_ms;
+    /** Nominal deadline of the next animation frame (0 if not scheduled yet)
+     */
+    time_ms_t next_frame;
+    /** Fixed segments of the current animation step, composed once when the
+     * step starts, so each frame only adds the moving segments. Released when
+     * the transition ends. */
+    GBitmap* background;
+    /** Animation step composed in background (0 if none) */
+    digit_anim_t background_anim;
+} digit_state_t;
+
+/** Segment images shared by all the digits of a given size.
+ *
+ * Retrieved once with digit_state_get_static_images() before drawing one or
+ * more digits, so the lookups are not repeated for every digit.
+ */
+typedef struct {
+    digit_size_t size;
+    /** Bitmap of each static segment */
+    GBitmap* bitmaps[7];
+    /** Placement of each static segment */
+    GRect rects[7];
+} digit_static_images_t;
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Initialize a digit state (displaying 0). */
+void
+digit_state_init(digit_state_t* state,
+                 digit_size_t size);
+
+/** Release the resources held by a digit state. */
+void
+digit_state_deinit(digit_state_t* state);
+
+/** Set the number to display.
+ *
+ * See digit_layer_set_number() for details. The whole transition from the
+ * displayed frame to the new number is compiled here, so animating only has to
+ * play the frames back. If the frames can not be allocated, the new number is
+ * displayed immediately.
+ *
+ * @return true if the displayed digit changed, and must be redrawn entirely
+ */
+bool
+digit_state_set_number(digit_state_t* state,
+                       unsigned target_number,
+                       bool animate);
+
+/** Skip all animations step and immediately display the correct digit. */
+void
+digit_state_kill_anim(digit_state_t* state);
+
+/** Set the quick-wrap flag.
+ *
+ * A running transition is compiled again from the displayed frame.
+ *
+ * @return true if the transition could not be compiled again, and the digit
+ * jumped to its target number
+ */
+bool
+digit_state_set_quick_wrap(digit_state_t* state,
+                           bool quick_wrap);
+
+/** Set the animation speed.
+ *
+ * A running transition is compiled again from the displayed frame.
+ *
+ * @return See digit_state_set_quick_wrap()
+ */
+bool
+digit_state_set_animate_speed(digit_state_t* state,
+                              animation_speed_t speed);
+
+/** Set the number of frames of each animation step.
+ *
+ * See digit_layer_set_step_count() for details. A running transition is
+ * restarted from the current animation step.
+ *
+ * @return See digit_state_set_quick_wrap()
+ */
+bool
+digit_state_set_step_count(digit_state_t* state,
+                           unsigned step_count);
+
+/** Return the duration of the transition to another number.
+ *
+ * The transition starts from the target number, as if it was displayed, and
+ * lasts until its last frame is displayed, with the current settings.
+ *
+ * @return The duration in milliseconds, 0 if the number does not change
+ */
+uint32_t
+digit_state_get_transition_ms(const digit_state_t* state,
+                              unsigned target_number);
+
+/** Move the animation forward.
+ *
+ * See digit_layer_animate() for details. A frame is only produced once its
+ * deadline is reached; the first deadline of an animation is set on the first
+ * call after it started. Following deadlines are derived from that start time
+ * and the frames durations, not from the time of the calls: when called late,
+ * the frames that should already be over are skipped.
+ *
+ * @param now Current time, from get_time_ms()
+ * @param next_frame Lowered to the deadline of the next frame if the digit
+ * still need to be animated
+ * @param dirty_rect Extended to cover the area of the digit that changed:
+ * the previous and current bounds of the moving segments, and the fixed
+ * segments that appeared or disappeared. Relative to the digit top-left
+ * corner. Left untouched if nothing changed.
+ * @return true if the digit still need to be animated.
+ */
+bool
+digit_state_animate(digit_state_t* state,
+                    time_ms_t now,
+                    time_ms_t* next_frame,
+                    GRect* dirty_rect);
+
+/** Retrieve the static segment images for a digit size.
+ *
+ * The segment images for this size must be loaded.
+ */
+void
+digit_state_get_static_images(digit_size_t size,
+                              digit_static_images_t* images);
+
+/** Draw a digit.
+ *
+ * The compositing mode of the context must be set to GCompOpOr.
+ *
+ * @param images Static segment images, from digit_state_get_static_images()
+ * @param offset Top-left corner of the digit in the layer
+ */
+void
+digit_state_draw(const digit_state_t* state,
+                 const digit_static_images_t* images,
+                 GPoint offset,
+                 GContext* ctx);
+
+/** Draw a digit into an offscreen bitmap.
+ *
+ * Segments are ORed in the bitmap; the area to redraw must have been cleared.
+ *
+ * @param offset Top-left corner of the digit in the bitmap
+ * @param clip Only this area of the bitmap is drawn
+ */
+void
+digit_state_draw_in_bitmap(const digit_state_t* state,
+                           const digit_static_images_t* images,
+                           GPoint offset,
+                           GRect clip,
+                           GBitmap* target);
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <pebble.h>
 
+#include "utils.h"
 #include "digit_info.h"
 
 // =======
@@ -36,6 +37,10 @@ digit_layer_create(digit_size_t size,
                    GPoint offset);
 
 /** Set the number currently displayed by the layer.
+ *
+ * Digits count up or down, whichever is shorter: going from 5 to 4 plays the
+ * 4 to 5 animation backward. A running animation may turn back from its current
+ * position if the new number is closer that way.
  *
  * @param animate Set to true to animate from the currently displayed digit to
  * the requested number, false to immediately change it. If the layer is already
@@ -58,7 +63,8 @@ digit_layer_kill_anim(DigitLayer* layer);
  * digit is required.
  *
  * For example, going from 2 to 5 will animate through 3 and 4, while going from
- * 5 to 2 will animate through 0 and 1 instead of 6, 7, 8, 9, 0, 1.
+ * 7 to 1 will animate through 0 instead of 6, 5, 4, 3, 2. The shortcut to 0
+ * can also be played backward: 0 to 7 animates directly.
  */
 void
 digit_layer_set_quick_wrap(DigitLayer* layer,
@@ -69,20 +75,38 @@ void
 digit_layer_set_animate_speed(DigitLayer* layer,
                               animation_speed_t speed);
 
+/** Set the number of frames of each animation step.
+ *
+ * The default is ANIM_KEYFRAME_COUNT (9), which displays the drawn keyframes.
+ * Fewer frames wake the watch less often, more frames give a smoother
+ * animation; the duration of the animation does not change. The minimum is 2.
+ */
+void
+digit_layer_set_step_count(DigitLayer* layer,
+                           unsigned step_count);
+
 /** Animate a layer.
  *
- * This function is responsible for actually moving the animation forward. Every
- * time it is called, and if the digit layer needs to be animated, it is done
- * there.
- * It is designed to be called every 100ms to ensure that FAST_MERGED animation
- * speed complete in less than a second.
+ * This function is responsible for actually moving the animation forward. The
+ * digit moves one frame when the deadline of that frame is reached; frames are
+ * 100ms apart (200ms for slow speeds) with the default step count (see
+ * digit_layer_set_step_count()), so that FAST_MERGED animation speed
+ * complete in less than a second. Deadlines are measured from the start of the
+ * animation: if this is called late, overdue frames are dropped so the
+ * animation still completes in time.
+ *
+ * @param now Current time, from get_time_ms()
+ * @param next_frame Lowered to the deadline of the next frame if the layer
+ * still need to be animated. The layer must be animated again at that time.
  *
  * @return true if the layer still need to be animated, false otherwise. A layer
  * returning false here will not need to be animated again unless its number is
  * changed.
  */
 bool
-digit_layer_animate(DigitLayer* layer);
+digit_layer_animate(DigitLayer* layer,
+                    time_ms_t now,
+                    time_ms_t* next_frame);
 
 /** Destroy a layer.
  */
@@ -7,9 +7,12 @@
 
 #include <pebble.h>
 
+#include "heap.h"
 #include "utils.h"
+#include "digit_glyphs.h"
+#include "digit_images.h"
 #include "digit_info.h"
-#include "digitlayer.h"
+#include "digit_state.h"
 
 #include "numberlayer.h"
 
@@ -17,12 +20,28 @@
 // PRIVATE TYPES =
 // ===============
 
-/** State of a number layer. */
+/** State of a number layer.
+ *
+ * The number layer owns the state of all its digits and draw them in a single
+ * update proc, instead of having one child layer per digit.
+ *
+ * The digits are drawn in a retained canvas. Only the area that changed since
+ * the last update (dirty_rect) is redrawn in the canvas, which is then copied
+ * to the screen. If the canvas could not be allocated, the digits are drawn
+ * directly on the screen instead.
+ */
 typedef struct {
+    digit_size_t size;
     unsigned digits_count;
     /** Target number to display */
     unsigned displayed_number;
-    DigitLayer* digits[];
+    /** Offscreen copy of the layer content, NULL if it could not be
+     * allocated
+     */
+    GBitmap* canvas;
+    /** Area of the canvas to redraw, relative to the layer bounds */
+    GRect dirty_rect;
+    digit_state_t digits[];
 } number_info_t;
 
 // ===============================
@@ -33,13 +52,45 @@ static inline
 number_info_t*
 get_info(NumberLayer* layer)
 {
-    return (number_info_t*) layer_get_data(layer);
+    return (number_info_t*) layer_get_init_data(layer);
+}
+
+/** Return the size of the custom data of a number layer */
+static inline
+size_t
+get_info_size(unsigned digit_count)
+{
+    return sizeof(number_info_t) + sizeof(digit_state_t) * digit_count;
 }
 
 static
 void
 info_init(number_info_t* info);
 
+/** Return the area of a digit, relative to the layer bounds */
+static
+GRect
+get_digit_rect(const number_info_t* info,
+               unsigned digit_index);
+
+/** Add an area to redraw and mark the layer dirty */
+static
+void
+add_dirty_rect(NumberLayer* layer,
+               GRect rect);
+
+/** Draw all the digits directly in the graphic context */
+static
+void
+draw_without_canvas(number_info_t* info,
+                    GContext* ctx);
+
+/** Draw all the digits */
+static
+void
+handle_layer_update(struct Layer* layer,
+                    GContext* ctx);
+
 // ==============================
 // PRIVATE FUNCTION DEFINITIONS =
 // ==============================
@@ -48,19 +99,131 @@ static
 void
 info_init(number_info_t* info)
 {
+    info->size = DS_BIG;
     info->digits_count = 0;
     info->displayed_number = 0;
+    info->canvas = NULL;
+    info->dirty_rect = GRectZero;
+}
+
+static
+GRect
+get_digit_rect(const number_info_t* info,
+               unsigned digit_index)
+{
+    GSize digit_size = digit_dimensions[info->size];
+    return GRect(digit_index * (digit_size.w + digit_spacing[info->size]),
+                 0,
+                 digit_size.w,
+                 digit_size.h);
+}
+
+static
+void
+add_dirty_rect(NumberLayer* layer,
+               GRect rect)
+{
+    if (rect_is_empty(rect)) {
+        return;
+    }
+
+    number_info_t* info = get_info(layer);
+    info->dirty_rect = rect_union(info->dirty_rect,
+                                  rect);
+    layer_mark_dirty(layer);
+}
+
+static
+void
+draw_without_canvas(number_info_t* info,
+                    GContext* ctx)
+{
+    digit_static_images_t images;
+    digit_state_get_static_images(info->size,
+                                  &images);
+    graphics_context_set_compositing_mode(ctx,
+                                          GCompOpOr);
+
+    for (unsigned i = 0;
+         i < info->digits_count;
+         ++i) {
+        digit_state_draw(&info->digits[i],
+                         &images,
+                         get_digit_rect(info,
+                                        i).origin,
+                         ctx);
+    }
+
+    info->dirty_rect = GRectZero;
+}
+
+static
+void
+handle_layer_update(struct Layer* layer,
+                    GContext* ctx)
+{
+    number_info_t* info = get_info(layer);
+    GRect layer_bounds = layer_get_bounds(layer);
+
+    if (!info->canvas) {
+        draw_without_canvas(info,
+                            ctx);
+        return;
+    }
+
+    if (!rect_is_empty(info->dirty_rect)) {
+        digit_static_images_t images;
+        digit_state_get_static_images(info->size,
+                                      &images);
+        bitmap_clear_rect(info->canvas,
+                          info->dirty_rect);
+
+        for (unsigned i = 0;
+             i < info->digits_count;
+             ++i) {
+            GRect digit_rect = get_digit_rect(info,
+                                              i);
+            GRect clip = rect_intersection(digit_rect,
+                                           info->dirty_rect);
+
+            if (rect_is_empty(clip)) {
+                continue;
+            }
+
+            digit_state_draw_in_bitmap(&info->digits[i],
+                                       &images,
+                                       digit_rect.origin,
+                                       clip,
+                                       info->canvas);
+        }
+
+        info->dirty_rect = GRectZero;
+    }
+
+    graphics_context_set_compositing_mode(ctx,
+                                          GCompOpOr);
+    graphics_draw_bitmap_in_rect(ctx,
+                                 info->canvas,
+                                 layer_bounds);
 }
 
 // =============================
 // PUBLIC FUNCTION DEFINITIONS =
 // =============================
 
+size_t
+number_layer_get_data_size(unsigned digit_count)
+{
+    return arena_piece_size(get_info_size(digit_count));
+}
+
 NumberLayer*
 number_layer_create(digit_size_t size,
                     unsigned digit_count,
                     GPoint offset)
 {
+    segment_load_images(size);
+    glyph_load_images(size);
     GRect layer_rect;
     layer_rect.origin = offset;
     unsigned digit_width = digit_dimensions[size].w;
@@ -69,28 +232,28 @@ number_layer_create(digit_size_t size,
     layer_rect.size = GSize(layer_width,
                             digit_dimensions[size].h);
 
-    size_t number_info_size = sizeof(number_info_t) +
-                              sizeof(DigitLayer*) * digit_count;
-
     NumberLayer* result =
-        layer_create_with_init_data(layer_rect,
-                                    number_info_size,
+        layer_create_with_init_data(HEAP_DIGITS,
+                                    layer_rect,
+                                    get_info_size(digit_count),
                                     (layer_data_init_t) info_init);
+    layer_set_update_proc(result,
+                          handle_layer_update);
     number_info_t* info = get_info(result);
+    info->size = size;
     info->digits_count = digit_count;
-
-    unsigned digit_placement_offset = digit_dimensions[size].w +
-                                      digit_spacing[size];
+    info->canvas = heap_gbitmap_create_blank(HEAP_DIGITS,
+                                             layer_rect.size);
+    info->dirty_rect = GRect(0,
+                             0,
+                             layer_rect.size.w,
+                             layer_rect.size.h);
 
     for (unsigned i = 0;
          i < digit_count;
          ++i) {
-        info->digits[i] =
-            digit_layer_create(size,
-                               GPoint(digit_placement_offset * i,
-                                      0));
-        layer_add_child(result,
-                        info->digits[i]);
+        digit_state_init(&info->digits[i],
+                         size);
     }
 
     return result;
@@ -116,9 +279,14 @@ number_layer_set_number(NumberLayer* layer,
          ++i) {
         unsigned digit_value = number % 10;
         number /= 10;
-        digit_layer_set_number(info->digits[--digit_index],
-                               digit_value,
-                               animate);
+
+        if (digit_state_set_number(&info->digits[--digit_index],
+                                   digit_value,
+                                   animate)) {
+            add_dirty_rect(layer,
+                           get_digit_rect(info,
+                                          digit_index));
+        }
     }
 }
 
@@ -130,8 +298,15 @@ number_layer_kill_anim(NumberLayer* layer)
     for (unsigned i = 0;
          i < info->digits_count;
          ++i) {
-        digit_layer_kill_anim(info->digits[i]);
+        digit_state_kill_anim(&info->digits[i]);
     }
+
+    GRect bounds = layer_get_bounds(layer);
+    add_dirty_rect(layer,
+                   GRect(0,
+                         0,
+                         bounds.size.w,
+                         bounds.size.h));
 }
 
 void
@@ -143,8 +318,12 @@ number_layer_set_quick_wrap(NumberLayer* layer,
     for (unsigned i = 0;
          i < info->digits_count;
          ++i) {
-        digit_layer_set_quick_wrap(info->digits[i],
-                                   quick_wrap);
+        if (digit_state_set_quick_wrap(&info->digits[i],
+                                       quick_wrap)) {
+            add_dirty_rect(layer,
+                           get_digit_rect(info,
+                                          i));
+        }
     }
 }
 
@@ -157,22 +336,94 @@ number_layer_set_animate_speed(NumberLayer* layer,
     for (unsigned i = 0;
          i < info->digits_count;
          ++i) {
-        digit_layer_set_animate_speed(info->digits[i],
-                                      speed);
+        if (digit_state_set_animate_speed(&info->digits[i],
+                                          speed)) {
+            add_dirty_rect(layer,
+                           get_digit_rect(info,
+                                          i));
+        }
     }
 }
 
+void
+number_layer_set_step_count(NumberLayer* layer,
+                            unsigned step_count)
+{
+    number_info_t* info = get_info(layer);
+
+    for (unsigned i = 0;
+         i < info->digits_count;
+         ++i) {
+        if (digit_state_set_step_count(&info->digits[i],
+                                       step_count)) {
+            add_dirty_rect(layer,
+                           get_digit_rect(info,
+                                          i));
+        }
+    }
+}
+
+uint32_t
+number_layer_get_transition_ms(NumberLayer* layer,
+                               unsigned number)
+{
+    number_info_t* info = get_info(layer);
+    uint32_t result = 0;
+
+    for (unsigned i = info->digits_count;
+         i > 0;
+         --i) {
+        uint32_t duration =
+            digit_state_get_transition_ms(&info->digits[i - 1],
+                                          number % 10);
+        number /= 10;
+
+        if (duration > result) {
+            result = duration;
+        }
+    }
+
+    return result;
+}
+
 bool
-number_layer_animate(NumberLayer* layer)
+number_layer_animate(NumberLayer* layer,
+                     time_ms_t now,
+                     time_ms_t* next_frame,
+                     bool* redrawn)
 {
+    if (layer_get_hidden(layer)) {
+        return false;
+    }
+
     number_info_t* info = get_info(layer);
 
     bool need_animate = false;
+    GRect dirty_rect = GRectZero;
 
     for (unsigned i = 0;
          i < info->digits_count;
          ++i) {
-        need_animate |= digit_layer_animate(info->digits[i]);
+        GRect digit_dirty_rect = GRectZero;
+        need_animate |= digit_state_animate(&info->digits[i],
+                                            now,
+                                            next_frame,
+                                            &digit_dirty_rect);
+
+        if (!rect_is_empty(digit_dirty_rect)) {
+            GPoint digit_origin = get_digit_rect(info,
+                                                 i).origin;
+            digit_dirty_rect.origin.x += digit_origin.x;
+            digit_dirty_rect.origin.y += digit_origin.y;
+            dirty_rect = rect_union(dirty_rect,
+                                    digit_dirty_rect);
+        }
+    }
+
+    if (!rect_is_empty(dirty_rect)) {
+        add_dirty_rect(layer,
+                       dirty_rect);
+        *redrawn = true;
     }
 
     return need_animate;
@@ -186,9 +437,16 @@ number_layer_destroy(NumberLayer* layer)
     for (unsigned i = 0;
          i < info->digits_count;
          ++i) {
-        digit_layer_destroy(info->digits[i]);
+        digit_state_deinit(&info->digits[i]);
     }
 
-    layer_destroy(layer);
-}
+    if (info->canvas) {
+        heap_gbitmap_destroy(HEAP_DIGITS,
+                             info->canvas);
+    }
 
+    glyph_unload_images(info->size);
+    segment_unload_images(info->size);
+    heap_layer_destroy(HEAP_DIGITS,
+                       layer);
+}
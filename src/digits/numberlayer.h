@@ -1,7 +1,8 @@
 /** @file
  * Number layer.
  *
- * A number layer is made of multiple digit layers, and update them when needed.
+ * A number layer display multiple animated digits, and update them when needed.
+ * All digits are drawn by the number layer itself in a single pass.
  *
  * @author Cley Faye
  * Licensing informations in LICENSE.md file.
@@ -12,6 +13,7 @@
 
 #include <pebble.h>
 
+#include "utils.h"
 #include "digit_info.h"
 
 // =======
@@ -34,6 +36,13 @@ number_layer_create(digit_size_t size,
                     unsigned digit_count,
                     GPoint offset);
 
+/** Return the room taken in the layer data arena by a number layer.
+ *
+ * @param digit_count The number of digit in the number.
+ */
+size_t
+number_layer_get_data_size(unsigned digit_count);
+
 /** Set the number displayed by the layer.
  *
  * @param animate Set to true to animate from the currently displayed digit to
@@ -66,15 +75,43 @@ void
 number_layer_set_animate_speed(NumberLayer* layer,
                                animation_speed_t speed);
 
+/** Set the number of frames of each animation step.
+ *
+ * See digit_layer_set_step_count() for details.
+ */
+void
+number_layer_set_step_count(NumberLayer* layer,
+                            unsigned step_count);
+
+/** Return the duration of the animation to another number.
+ *
+ * See digit_state_get_transition_ms(): the animation starts from the number
+ * set with number_layer_set_number(), as if it was displayed.
+ *
+ * @return The duration in milliseconds of the longest digit transition
+ */
+uint32_t
+number_layer_get_transition_ms(NumberLayer* layer,
+                               unsigned number);
+
 /** Animate a layer.
  *
- * This function is responsible for actually moving the animation forward. It
- * must be called every 100ms.
+ * This function is responsible for actually moving the animation forward. Each
+ * digit only moves when its own frame deadline is reached, so it can be called
+ * at any time; it must be called again at the returned deadline.
  *
+ * @param now Current time, from get_time_ms()
+ * @param next_frame Lowered to the earliest frame deadline of the digits that
+ * still need to be animated
+ * @param redrawn Set to true if a digit moved and the layer must be redrawn,
+ * left unchanged otherwise
  * @return true if the layer still need to be animated, false otherwise.
  */
 bool
-number_layer_animate(NumberLayer* layer);
+number_layer_animate(NumberLayer* layer,
+                     time_ms_t now,
+                     time_ms_t* next_frame,
+                     bool* redrawn);
 
 /** Destroy a layer.
  *
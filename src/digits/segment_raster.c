@@ -0,0 +1,92 @@
+/** @file
+ * Implementation of the procedural segment images.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "heap.h"
+#include "digit_info.h"
+
+#include "segment_raster.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Shape of the segments of a digit size, in pixels. */
+typedef struct {
+    /** Length, from tip to tip */
+    int32_t length;
+    /** Thickness */
+    int32_t thickness;
+} segment_shape_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Shape of the segments for each digit size.
+ *
+ * Matching the horizontal and vertical segment images.
+ */
+static
+const segment_shape_t segment_shapes[DIGITS_SIZE_COUNT] = {
+    {34, 9}, {32, 7}, {12, 3}
+};
+
+/** Angle between two orientations, in trigonometric angle unit */
+static
+const int32_t orientation_angle_step = TRIG_MAX_ANGLE / 40;
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+GBitmap*
+segment_raster_create(digit_size_t size,
+                      segment_orientation_t orientation,
+                      GSize bitmap_size)
+{
+    GBitmap* result = heap_gbitmap_create_blank(HEAP_SEGMENTS,
+                                                bitmap_size);
+
+    if (!result) {
+        return NULL;
+    }
+
+    // The segment axis goes from (0, -1) at SO_VERTICAL, clockwise
+    int32_t angle = orientation * orientation_angle_step;
+    int32_t axis_x = sin_lookup(angle);
+    int32_t axis_y = -cos_lookup(angle);
+    // Compared values are doubled, so pixel centers are on integers
+    int32_t max_across = segment_shapes[size].thickness * TRIG_MAX_RATIO;
+    int32_t max_along = segment_shapes[size].length * TRIG_MAX_RATIO;
+    uint8_t* row = (uint8_t*) result->addr;
+
+    for (int y = 0;
+         y < bitmap_size.h;
+         ++y) {
+        int32_t dy = 2 * y + 1 - bitmap_size.h;
+
+        for (int x = 0;
+             x < bitmap_size.w;
+             ++x) {
+            int32_t dx = 2 * x + 1 - bitmap_size.w;
+            int32_t along = dx * axis_x + dy * axis_y;
+            int32_t across = dy * axis_x - dx * axis_y;
+            along = along < 0 ? -along : along;
+            across = across < 0 ? -across : across;
+
+            if (across <= max_across && along + across <= max_along) {
+                row[x >> 3] |= 1u << (x & 7);
+            }
+        }
+
+        row += result->row_size_bytes;
+    }
+
+    return result;
+}
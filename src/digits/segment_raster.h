@@ -0,0 +1,38 @@
+/** @file
+ * Procedural segment images.
+ *
+ * Generate the segment image of any orientation from a parametric shape,
+ * instead of decoding one image resource per orientation. A segment is a
+ * bar of a given length and thickness, with pointy ends cut at 45 degrees,
+ * rotated by 9 degrees for each orientation step.
+ *
+ * Used by digit_images when built with PROCEDURAL_SEGMENTS defined.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_SEGMENT_RASTER_H
+#define INCL_SEGMENT_RASTER_H
+
+#include <pebble.h>
+
+#include "digit_info.h"
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Create the image of a segment.
+ *
+ * The segment is centered in the bitmap.
+ *
+ * @param bitmap_size Size of the resulting bitmap
+ * @return The new bitmap, or NULL on allocation failure
+ */
+GBitmap*
+segment_raster_create(digit_size_t size,
+                      segment_orientation_t orientation,
+                      GSize bitmap_size);
+
+#endif
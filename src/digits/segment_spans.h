@@ -0,0 +1,72 @@
+/** @file
+ * Span-encoded segments.
+ *
+ * Rotated segments are mostly empty in their bounding box. Instead of a
+ * bitmap, each segment orientation is described as the list of horizontal runs
+ * of white pixels (spans) of each scanline, so it can be drawn with span fills
+ * that only touch the segment pixels.
+ *
+ * The span tables are generated from the segment images by
+ * extra/atlas/makeatlas.py when configuring, in segment_spans.auto.c. They are
+ * not available when segments are generated (PROCEDURAL_SEGMENTS).
+ *
+ * Orientations whose image is an exact copy or horizontal mirror of another
+ * one of the same size share its spans; mirrored spans must be placed with
+ * segment_span_get_x().
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_SEGMENT_SPANS_H
+#define INCL_SEGMENT_SPANS_H
+
+#include <pebble.h>
+
+#include "digit_info.h"
+
+// =======
+// TYPES =
+// =======
+
+/** A horizontal run of white pixels, relative to the segment top-left corner */
+typedef struct {
+    uint8_t y;
+    uint8_t x;
+    uint8_t length;
+} segment_span_t;
+
+/** All the spans of a segment orientation, from top to bottom */
+typedef struct {
+    const segment_span_t* spans;
+    uint16_t count;
+    /** If not 0, the spans are mirrored horizontally across this width */
+    uint8_t mirror_width;
+} segment_spans_t;
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Return the left of a span, relative to the segment top-left corner */
+static inline
+int
+segment_span_get_x(const segment_spans_t* spans,
+                   const segment_span_t* span)
+{
+    return spans->mirror_width
+           ? spans->mirror_width - span->x - span->length
+           : span->x;
+}
+
+// =========
+// EXTERNS =
+// =========
+
+#ifndef PROCEDURAL_SEGMENTS
+/** Spans of every segment orientation of every digit size. */
+extern
+const segment_spans_t segment_spans[DIGITS_SIZE_COUNT][SEGMENTS_ORIENTATION_COUNT];
+#endif
+
+#endif
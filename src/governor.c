@@ -0,0 +1,186 @@
+/** @file
+ * Battery-aware animation governor.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "governor.h"
+
+// ===============
+// PRIVATE TYPES =
+// ===============
+
+/** Battery thresholds of a level, in percent */
+typedef struct {
+    /** The level is entered from the previous one at or below this charge */
+    uint8_t enter_below;
+    /** The level is left for the previous one at or above this charge */
+    uint8_t leave_above;
+} level_thresholds_t;
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Thresholds of each level (unused for GOVERNOR_FULL).
+ *
+ * The battery charge is reported in steps of 10%; the gap between entering and
+ * leaving a level spans at least one step.
+ */
+static
+const level_thresholds_t level_thresholds[GOVERNOR_LEVEL_COUNT] = {
+    {0, 0},
+    {30, 50},
+    {10, 20},
+};
+
+/** Duration of a counter slot, in seconds */
+static
+const time_t counter_period = 3600;
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+static
+governor_level_t current_level = GOVERNOR_FULL;
+
+/** Frames rendered in each hour, indexed by hour modulo the history size */
+static
+uint16_t frame_counters[GOVERNOR_HISTORY_HOURS];
+
+/** Hour (UNIX time / counter_period) of the most recent counter */
+static
+time_t counter_hour = 0;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Move the frame counters to the current hour.
+ *
+ * The counters of the hours skipped since the last frame are cleared.
+ */
+static
+void
+roll_counters(void);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+roll_counters(void)
+{
+    time_t hour = time(NULL) / counter_period;
+
+    if (hour == counter_hour) {
+        return;
+    }
+
+#ifdef LOG_TIMINGS
+    if (counter_hour != 0) {
+        APP_LOG(APP_LOG_LEVEL_INFO,
+                "governor: %u frames in the last hour, level %u",
+                frame_counters[counter_hour % GOVERNOR_HISTORY_HOURS],
+                current_level);
+    }
+#endif
+
+    time_t elapsed = hour - counter_hour;
+
+    if (counter_hour == 0 || elapsed > GOVERNOR_HISTORY_HOURS) {
+        elapsed = GOVERNOR_HISTORY_HOURS;
+    }
+
+    for (time_t cleared = 1;
+         cleared <= elapsed;
+         ++cleared) {
+        frame_counters[(hour - elapsed + cleared) % GOVERNOR_HISTORY_HOURS] =
+            0;
+    }
+
+    counter_hour = hour;
+}
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+bool
+governor_update(BatteryChargeState charge)
+{
+    governor_level_t level = current_level;
+
+    if (charge.is_charging || charge.is_plugged) {
+        level = GOVERNOR_FULL;
+    } else {
+        // Go down as far as the charge requires
+        while (level + 1 < GOVERNOR_LEVEL_COUNT &&
+               charge.charge_percent <=
+               level_thresholds[level + 1].enter_below) {
+            ++level;
+        }
+
+        // Or up as far as the charge allows
+        while (level > GOVERNOR_FULL &&
+               charge.charge_percent >= level_thresholds[level].leave_above) {
+            --level;
+        }
+    }
+
+    if (level == current_level) {
+        return false;
+    }
+
+    roll_counters();
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "governor: level %u -> %u at %u%%",
+            current_level,
+            level,
+            charge.charge_percent);
+    current_level = level;
+    return true;
+}
+
+governor_level_t
+governor_get_level(void)
+{
+    return current_level;
+}
+
+unsigned
+governor_step_count(unsigned step_count)
+{
+    return (current_level != GOVERNOR_FULL &&
+            step_count > GOVERNOR_REDUCED_STEP_COUNT)
+           ? GOVERNOR_REDUCED_STEP_COUNT
+           : step_count;
+}
+
+void
+governor_count_frame(void)
+{
+    roll_counters();
+    uint16_t* counter = &frame_counters[counter_hour % GOVERNOR_HISTORY_HOURS];
+
+    if (*counter < UINT16_MAX) {
+        ++*counter;
+    }
+}
+
+unsigned
+governor_get_frames(unsigned hours_ago)
+{
+    if (hours_ago >= GOVERNOR_HISTORY_HOURS) {
+        return 0;
+    }
+
+    roll_counters();
+    return frame_counters[(counter_hour - hours_ago) % GOVERNOR_HISTORY_HOURS];
+}
+
@@ -0,0 +1,90 @@
+/** @file
+ * Battery-aware animation governor.
+ *
+ * The governor lowers the cost of the digit animations as the battery charge
+ * drops: full animations, then animations with fewer frames per step, then
+ * plain digit swaps. Each level is left at a higher charge than the one it is
+ * entered at, so the level does not flap when the charge hovers around a
+ * threshold. While the watch is charging, animations are always complete.
+ *
+ * The governor also counts the animation frames rendered in each hour of the
+ * last day, so the effect of each level can be checked; they are logged when
+ * the application exits.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_GOVERNOR_H
+#define INCL_GOVERNOR_H
+
+#include <pebble.h>
+
+// =======
+// TYPES =
+// =======
+
+/** Animation level allowed by the governor */
+typedef enum {
+    /** Animations as configured */
+    GOVERNOR_FULL,
+    /** Animations with fewer frames per step */
+    GOVERNOR_REDUCED,
+    /** No animation, digits are swapped */
+    GOVERNOR_STATIC,
+    GOVERNOR_LEVEL_COUNT
+} governor_level_t;
+
+// ========
+// CONSTS =
+// ========
+
+/** Number of hours of frame counters kept */
+#define GOVERNOR_HISTORY_HOURS 24
+
+/** Maximum number of frames per animation step at GOVERNOR_REDUCED */
+#define GOVERNOR_REDUCED_STEP_COUNT 4
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Update the governor level from a battery state.
+ *
+ * @return true if the level changed
+ */
+bool
+governor_update(BatteryChargeState charge);
+
+/** Return the current governor level. */
+governor_level_t
+governor_get_level(void);
+
+/** Return true if digits can be animated at the current level. */
+static inline
+bool
+governor_can_animate(void)
+{
+    return governor_get_level() != GOVERNOR_STATIC;
+}
+
+/** Return the number of frames per animation step allowed by the governor.
+ *
+ * @param step_count Number of frames per step from the user settings
+ */
+unsigned
+governor_step_count(unsigned step_count);
+
+/** Count a rendered animation frame in the current hour. */
+void
+governor_count_frame(void);
+
+/** Return the number of animation frames rendered in a past hour.
+ *
+ * @param hours_ago 0 for the current hour, up to GOVERNOR_HISTORY_HOURS - 1
+ */
+unsigned
+governor_get_frames(unsigned hours_ago);
+
+#endif
+
@@ -0,0 +1,244 @@
+/** @file
+ * Heap accounting.
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#include <pebble.h>
+
+#include "utils.h"
+
+#include "heap.h"
+
+// ================
+// PRIVATE CONSTS =
+// ================
+
+static
+const char* const tag_names[HEAP_TAG_COUNT] = {
+    "segments", "digits", "widgets", "window", "layer data", "config"
+};
+
+STATIC_ASSERT(ARRAY_COUNT(tag_names) == HEAP_TAG_COUNT, tag_names_count);
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+static
+heap_usage_t usages[HEAP_TAG_COUNT];
+
+/** Sum of all the accounted changes, modulo SIZE_MAX + 1.
+ *
+ * Removing it from heap_bytes_used() gives a baseline that does not move when
+ * nested blocks account their own changes.
+ */
+static
+size_t accounted = 0;
+
+/** Highest heap_bytes_used() seen after an accounted allocation */
+static
+size_t total_high_water = 0;
+
+// ==============================
+// PUBLIC FUNCTIONS DEFINITIONS =
+// ==============================
+
+size_t
+heap_track_begin(void)
+{
+    return heap_bytes_used() - accounted;
+}
+
+void
+heap_track_end(heap_tag_t tag,
+               size_t begin)
+{
+    size_t used = heap_bytes_used();
+    int32_t change = (int32_t) (used - accounted - begin);
+    heap_usage_t* usage = &usages[tag];
+    accounted += change;
+    usage->current += change;
+
+    if (usage->current > usage->high_water) {
+        usage->high_water = usage->current;
+    }
+
+    if (used > total_high_water) {
+        total_high_water = used;
+    }
+}
+
+GBitmap*
+heap_gbitmap_create_with_resource(heap_tag_t tag,
+                                  uint32_t resource_id)
+{
+    size_t begin = heap_track_begin();
+    GBitmap* result = gbitmap_create_with_resource(resource_id);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+GBitmap*
+heap_gbitmap_create_blank(heap_tag_t tag,
+                          GSize size)
+{
+    size_t begin = heap_track_begin();
+    GBitmap* result = gbitmap_create_blank(size);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+GBitmap*
+heap_gbitmap_create_as_sub_bitmap(heap_tag_t tag,
+                                  const GBitmap* base_bitmap,
+                                  GRect sub_rect)
+{
+    size_t begin = heap_track_begin();
+    GBitmap* result = gbitmap_create_as_sub_bitmap(base_bitmap,
+                                                   sub_rect);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+void
+heap_gbitmap_destroy(heap_tag_t tag,
+                     GBitmap* bitmap)
+{
+    size_t begin = heap_track_begin();
+    gbitmap_destroy(bitmap);
+    heap_track_end(tag,
+                   begin);
+}
+
+Layer*
+heap_layer_create(heap_tag_t tag,
+                  GRect frame)
+{
+    size_t begin = heap_track_begin();
+    Layer* result = layer_create(frame);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+Layer*
+heap_layer_create_with_data(heap_tag_t tag,
+                            GRect frame,
+                            size_t data_size)
+{
+    size_t begin = heap_track_begin();
+    Layer* result = layer_create_with_data(frame,
+                                           data_size);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+void
+heap_layer_destroy(heap_tag_t tag,
+                   Layer* layer)
+{
+    size_t begin = heap_track_begin();
+    layer_destroy(layer);
+    heap_track_end(tag,
+                   begin);
+}
+
+TextLayer*
+heap_text_layer_create(heap_tag_t tag,
+                       GRect frame)
+{
+    size_t begin = heap_track_begin();
+    TextLayer* result = text_layer_create(frame);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+void
+heap_text_layer_destroy(heap_tag_t tag,
+                        TextLayer* text_layer)
+{
+    size_t begin = heap_track_begin();
+    text_layer_destroy(text_layer);
+    heap_track_end(tag,
+                   begin);
+}
+
+InverterLayer*
+heap_inverter_layer_create(heap_tag_t tag,
+                           GRect frame)
+{
+    size_t begin = heap_track_begin();
+    InverterLayer* result = inverter_layer_create(frame);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+void
+heap_inverter_layer_destroy(heap_tag_t tag,
+                            InverterLayer* inverter_layer)
+{
+    size_t begin = heap_track_begin();
+    inverter_layer_destroy(inverter_layer);
+    heap_track_end(tag,
+                   begin);
+}
+
+void*
+heap_malloc(heap_tag_t tag,
+            size_t size)
+{
+    size_t begin = heap_track_begin();
+    void* result = malloc(size);
+    heap_track_end(tag,
+                   begin);
+    return result;
+}
+
+void
+heap_free(heap_tag_t tag,
+          void* pointer)
+{
+    size_t begin = heap_track_begin();
+    free(pointer);
+    heap_track_end(tag,
+                   begin);
+}
+
+void
+heap_log_usage(const char* event)
+{
+    int32_t tracked = 0;
+
+    for (int tag = 0;
+         tag < HEAP_TAG_COUNT;
+         ++tag) {
+        APP_LOG(APP_LOG_LEVEL_INFO,
+                "heap: %s: %s %ld bytes, high-water %ld",
+                event,
+                tag_names[tag],
+                (long) usages[tag].current,
+                (long) usages[tag].high_water);
+        tracked += usages[tag].current;
+    }
+
+    size_t used = heap_bytes_used();
+    APP_LOG(APP_LOG_LEVEL_INFO,
+            "heap: %s: used %lu bytes (%ld untracked), high-water %lu, "
+            "free %lu",
+            event,
+            (unsigned long) used,
+            (long) used - (long) tracked,
+            (unsigned long) (used > total_high_water
+                             ? used
+                             : total_high_water),
+            (unsigned long) heap_bytes_free());
+}
+
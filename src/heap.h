@@ -0,0 +1,143 @@
+/** @file
+ * Heap accounting.
+ *
+ * Allocations are tagged by subsystem, and each subsystem keeps its current and
+ * high-water heap usage. The wrappers below replace the SDK allocation
+ * functions; each of them measures the change of heap_bytes_used() around the
+ * SDK call, so the real cost of opaque objects (layers, bitmap headers) is
+ * counted, not only the size requested by the application.
+ *
+ * Anything else that allocates (window_create(), app_message_open()) can be
+ * measured with heap_track_begin() and heap_track_end().
+ *
+ * @author Cley Faye
+ * Licensing informations in LICENSE.md file.
+ */
+
+#ifndef INCL_HEAP_H
+#define INCL_HEAP_H
+
+#include <pebble.h>
+
+// =======
+// TYPES =
+// =======
+
+/** Subsystem an allocation is accounted to */
+typedef enum {
+    /** Segment images, atlases and glyphs shared by all the digits */
+    HEAP_SEGMENTS,
+    /** Digit and number layers, their canvas and compiled transitions */
+    HEAP_DIGITS,
+    /** Widget layers, text layers and images */
+    HEAP_WIDGETS,
+    /** Main window, its state and the inverter */
+    HEAP_WINDOW,
+    /** Arena holding the custom data of the window layers */
+    HEAP_LAYER_DATA,
+    /** AppMessage buffers */
+    HEAP_CONFIG,
+    HEAP_TAG_COUNT
+} heap_tag_t;
+
+/** Heap usage of a subsystem, in bytes */
+typedef struct {
+    int32_t current;
+    int32_t high_water;
+} heap_usage_t;
+
+// ===============================
+// PUBLIC FUNCTIONS DECLARATIONS =
+// ===============================
+
+/** Start measuring the allocations of a block of code.
+ *
+ * Blocks can be nested: what an inner block accounts is left out of the outer
+ * one.
+ *
+ * @return The value to pass to heap_track_end()
+ */
+size_t
+heap_track_begin(void);
+
+/** Account the heap usage change since heap_track_begin() to a subsystem. */
+void
+heap_track_end(heap_tag_t tag,
+               size_t begin);
+
+/** Accounted gbitmap_create_with_resource() */
+GBitmap*
+heap_gbitmap_create_with_resource(heap_tag_t tag,
+                                  uint32_t resource_id);
+
+/** Accounted gbitmap_create_blank() */
+GBitmap*
+heap_gbitmap_create_blank(heap_tag_t tag,
+                          GSize size);
+
+/** Accounted gbitmap_create_as_sub_bitmap() */
+GBitmap*
+heap_gbitmap_create_as_sub_bitmap(heap_tag_t tag,
+                                  const GBitmap* base_bitmap,
+                                  GRect sub_rect);
+
+/** Accounted gbitmap_destroy() */
+void
+heap_gbitmap_destroy(heap_tag_t tag,
+                     GBitmap* bitmap);
+
+/** Accounted layer_create() */
+Layer*
+heap_layer_create(heap_tag_t tag,
+                  GRect frame);
+
+/** Accounted layer_create_with_data() */
+Layer*
+heap_layer_create_with_data(heap_tag_t tag,
+                            GRect frame,
+                            size_t data_size);
+
+/** Accounted layer_destroy() */
+void
+heap_layer_destroy(heap_tag_t tag,
+                   Layer* layer);
+
+/** Accounted text_layer_create() */
+TextLayer*
+heap_text_layer_create(heap_tag_t tag,
+                       GRect frame);
+
+/** Accounted text_layer_destroy() */
+void
+heap_text_layer_destroy(heap_tag_t tag,
+                        TextLayer* text_layer);
+
+/** Accounted inverter_layer_create() */
+InverterLayer*
+heap_inverter_layer_create(heap_tag_t tag,
+                           GRect frame);
+
+/** Accounted inverter_layer_destroy() */
+void
+heap_inverter_layer_destroy(heap_tag_t tag,
+                            InverterLayer* inverter_layer);
+
+/** Accounted malloc() */
+void*
+heap_malloc(heap_tag_t tag,
+            size_t size);
+
+/** Accounted free() */
+void
+heap_free(heap_tag_t tag,
+          void* pointer);
+
+/** Log the heap usage of every subsystem, and of the whole heap.
+ *
+ * @param event What triggered the report, printed in the log
+ */
+void
+heap_log_usage(const char* event);
+
+#endif
+
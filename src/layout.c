@@ -8,6 +8,8 @@
 #include <pebble.h>
 
 #include "config.h"
+#include "digits/digit_anim.h"
+#include "governor.h"
 
 #include "layout.h"
 
@@ -175,6 +177,28 @@ layout_widgets_shaketimer(void)
     }
 }
 
+unsigned
+layout_anim_step_count(void)
+{
+    unsigned step_count;
+
+    switch (cfg_get_anim_smoothness()) {
+    case ANIM_SMOOTHNESS_LOW:
+        step_count = 4;
+        break;
+
+    default:
+    case ANIM_SMOOTHNESS_NORMAL:
+        step_count = ANIM_KEYFRAME_COUNT;
+        break;
+
+    case ANIM_SMOOTHNESS_SMOOTH:
+        step_count = 15;
+    }
+
+    return governor_step_count(step_count);
+}
+
 bool
 layout_widget_is_active(widget_type_t widget)
 {
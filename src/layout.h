@@ -66,7 +66,7 @@ bool
 layout_is_white_background(void);
 
 /** Return true if the widgets are hidden unless the watch is shook */
-inline
+static inline
 bool
 layout_widgets_hidden(void)
 {
@@ -81,6 +81,14 @@ layout_widgets_hidden(void)
 int
 layout_widgets_shaketimer(void);
 
+/** Return the number of frames of each digit animation step.
+ *
+ * This is the user setting, lowered by the battery governor if needed. See
+ * digit_layer_set_step_count().
+ */
+unsigned
+layout_anim_step_count(void);
+
 /** Determine if a given widget should be loaded.
  *
  * A widget should be loaded if it is enabled and if the general widget setting
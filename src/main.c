@@ -8,6 +8,8 @@
 #include <pebble.h>
 
 #include "config.h"
+#include "governor.h"
+#include "heap.h"
 #include "mainwindow.h"
 
 // ================================
@@ -16,6 +18,7 @@
 
 static void init(MainWindow** main_window);
 static void clear(MainWindow* main_window);
+static void log_animation_frames(void);
 
 // ===============================
 // PRIVATE FUNCTIONS DEFINITIONS =
@@ -28,8 +31,12 @@ void init(MainWindow** main_window)
 
     MainWindow* window;
     window = main_window_create();
+    // Opening AppMessage allocates its buffers
+    size_t heap_begin = heap_track_begin();
     cfg_init((config_callback_t) main_window_update_settings,
              window);
+    heap_track_end(HEAP_CONFIG,
+                   heap_begin);
     window_stack_push(window,
                       true);
 
@@ -38,10 +45,29 @@ void init(MainWindow** main_window)
 
 static void clear(MainWindow* main_window)
 {
+    heap_log_usage("exit");
+    log_animation_frames();
     main_window_destroy(main_window);
     cfg_clear();
 }
 
+/** Log the animation frames counted by the governor over the last day */
+static void log_animation_frames(void)
+{
+    for (unsigned hours_ago = 0;
+         hours_ago < GOVERNOR_HISTORY_HOURS;
+         ++hours_ago) {
+        unsigned frames = governor_get_frames(hours_ago);
+
+        if (frames > 0) {
+            APP_LOG(APP_LOG_LEVEL_INFO,
+                    "governor: %u frames %u hours ago",
+                    frames,
+                    hours_ago);
+        }
+    }
+}
+
 // ======
 // MAIN =
 // ======
@@ -15,7 +15,10 @@
 #include "widgets/batterylayer.h"
 #include "widgets/daytimelayer.h"
 #include "config.h"
+#include "governor.h"
+#include "heap.h"
 #include "layout.h"
+#include "utils.h"
 
 #include "mainwindow.h"
 
@@ -38,8 +41,25 @@ typedef struct {
     /** Color invertion layer */
     InverterLayer* inverter;
 
-    /** Animation timer */
+    /** Custom data of all the layers above, released with them */
+    arena_t layer_arena;
+    /** Piece of layer_arena holding the data of each widget, reused when the
+     * widget is rebuilt
+     */
+    arena_t widget_arenas[WIDGET_TYPE_COUNT];
+    /** Piece of layer_arena holding the data of extrawidget_daytime */
+    arena_t daytime_arena;
+
+    /** Animation timer, set to wake up at the next frame deadline */
     AppTimer* animation_timer;
+    /** Timer starting the animation to the next minute ahead of time */
+    AppTimer* preroll_timer;
+    /** Start of the minute the pre-rolled animation must end on */
+    time_ms_t preroll_minute;
+    /** Start of the minute displayed ahead of time by the last pre-rolled
+     * animation
+     */
+    time_ms_t preroll_shown;
     /** Timer to hide the widgets */
     AppTimer* widget_timer;
 
@@ -52,6 +72,12 @@ typedef struct {
      * load)
      */
     bool extra_animation;
+#ifdef LOG_TIMINGS
+    /** Flag indicating that hours or minutes were animated on the last
+     * animation clock run
+     */
+    bool time_animated;
+#endif
 } window_info_t;
 
 // ===================
@@ -81,12 +107,54 @@ static
 void
 clear_components(window_info_t* info);
 
+/** Update the components after a settings change.
+ *
+ * Only the components whose settings changed are rebuilt; the others are moved
+ * if the layout changed. Hours and minutes are never rebuilt, so the segment
+ * images they share stay loaded.
+ *
+ * @return true if a component was created
+ */
+static
+bool
+update_components(MainWindow* window,
+                  const cfg_changes_t* changes);
+
+/** Put the components back in the order lay_components() adds them.
+ *
+ * Widgets can share a position, so the last one added must stay on top.
+ */
+static
+void
+restack_components(MainWindow* window);
+
+/** Create or destroy the inverter to match the settings */
+static
+void
+update_inverter(MainWindow* window);
+
+/** Move a layer without changing its size */
+static
+void
+move_layer(Layer* layer,
+           GPoint origin);
+
 /** Set the animation speed of animated layers for hour/minutes */
 static
 void
 set_anim_speed(window_info_t* info,
                bool forced_speed);
 
+/** Set the number of frames per animation step of all animated layers */
+static
+void
+set_anim_step_count(window_info_t* info);
+
+/** Apply a governor level change to the displayed layers */
+static
+void
+apply_governor_level(window_info_t* info);
+
 // SERVICES HANDLING =
 
 /** Register all pertinent services.
@@ -129,6 +197,11 @@ set_to_time(window_info_t* info,
             struct tm* tick_time,
             bool animate);
 
+/** Return the hour to display, according to the 12h/24h clock style. */
+static
+int
+get_display_hour(int hour);
+
 /** Update the time on widgets.
  *
  * This is called by main_window_update_time(), and when the widgets are
@@ -146,11 +219,48 @@ static
 void
 animate_random(window_info_t* info);
 
-/** Schedule (if needed) the animation timer */
+/** Run the animation clock.
+ *
+ * Move forward the animations whose frame deadline is reached, then set the
+ * animation timer to the earliest deadline of all animated layers. The timer
+ * is cancelled when nothing is animated anymore.
+ *
+ * @return true if a layer moved and must be redrawn
+ */
 static
-void
+bool
 schedule_animation(window_info_t* info);
 
+/** Schedule the animation to the next minute ahead of time.
+ *
+ * When enabled, the animation to the next minute is started early enough for
+ * its last frame to be displayed when the minute changes, instead of starting
+ * on the minute tick. Nothing is done if it is already scheduled.
+ */
+static
+void
+schedule_preroll(window_info_t* info);
+
+/** Set the preroll timer to start the animation to a given minute.
+ *
+ * @param minute Start of the minute the animation must end on
+ */
+static
+void
+set_preroll_timer(window_info_t* info,
+                  time_ms_t minute);
+
+/** Cancel the pre-rolled animation */
+static
+void
+cancel_preroll(window_info_t* info);
+
+/** Return the duration of the animation to the time of a given minute. */
+static
+uint32_t
+get_preroll_duration(window_info_t* info,
+                     time_ms_t minute);
+
 /** Switch animation speed to forced anim. speed.
  *
  * Forced anim speed last until there is no more animation to process.
@@ -231,6 +341,11 @@ static
 void
 handle_anim_timer(window_info_t* info);
 
+/** Handle the preroll timer event: start the animation to the next minute */
+static
+void
+handle_preroll_timer(window_info_t* info);
+
 // HELPER =
 
 /** Return true if we are within a "vibrate" period */
@@ -270,6 +385,19 @@ lay_components(MainWindow* window)
     window_info_t* info = get_info(window);
     clear_components(info);
 
+    // One block for the data of all the layers, so rebuilding the components
+    // does not leave holes of various sizes in the heap
+    size_t data_size = number_layer_get_data_size(2) * 2 +
+                       seconds_layer_get_data_size() +
+                       date_layer_get_data_size() +
+                       bt_layer_get_data_size() +
+                       battery_layer_get_data_size() +
+                       daytime_layer_get_data_size();
+    arena_create(&info->layer_arena,
+                 HEAP_LAYER_DATA,
+                 data_size);
+    layer_set_data_arena(&info->layer_arena);
+
     Layer* window_layer = window_get_root_layer(window);
     // Base watchface (hours/minutes)
     info->hours = number_layer_create(DS_BIG,
@@ -291,23 +419,36 @@ lay_components(MainWindow* window)
                     info->minutes);
 
     // Widgets
-#define WIDGETCREATE(type) \
+#define WIDGETCREATE(type, widget) \
     do { \
+        arena_split(&info->layer_arena, \
+                    &info->widget_arenas[widget], \
+                    type##_layer_get_data_size()); \
+        layer_set_data_arena(&info->widget_arenas[widget]); \
         info->widget_##type = type##_layer_create(); \
         if (info->widget_##type) { \
             layer_add_child(window_layer, \
                             info->widget_##type); \
         } \
     } while (false)
-    WIDGETCREATE(seconds);
-    WIDGETCREATE(date);
-    WIDGETCREATE(bt);
-    WIDGETCREATE(battery);
+    WIDGETCREATE(seconds,
+                 WT_SECONDS);
+    WIDGETCREATE(date,
+                 WT_DATE);
+    WIDGETCREATE(bt,
+                 WT_BLUETOOTH);
+    WIDGETCREATE(battery,
+                 WT_BATTERY);
 #undef WIDGETCREATE
+    set_anim_step_count(info);
     set_widget_visibility(info,
                           !layout_widgets_hidden());
 
     // Extra widgets
+    arena_split(&info->layer_arena,
+                &info->daytime_arena,
+                daytime_layer_get_data_size());
+    layer_set_data_arena(&info->daytime_arena);
     info->extrawidget_daytime = daytime_layer_create();
 
     if (info->extrawidget_daytime) {
@@ -315,15 +456,10 @@ lay_components(MainWindow* window)
                         info->extrawidget_daytime);
     }
 
+    layer_set_data_arena(NULL);
+
     // Must be last: the inverter, if required
-    if (layout_is_white_background()) {
-        info->inverter = inverter_layer_create(GRect(0,
-                                               0,
-                                               144,
-                                               168));
-        layer_add_child(window_layer,
-                        inverter_layer_get_layer(info->inverter));
-    }
+    update_inverter(window);
 }
 
 static
@@ -356,9 +492,214 @@ clear_components(window_info_t* info)
     }
 
     if (info->inverter) {
-        inverter_layer_destroy(info->inverter);
+        heap_inverter_layer_destroy(HEAP_WINDOW,
+                                    info->inverter);
+        info->inverter = NULL;
+    }
+
+    arena_release(&info->layer_arena);
+
+    // The widget pieces went with it
+    for (unsigned widget = 0;
+         widget < WIDGET_TYPE_COUNT;
+         ++widget) {
+        info->widget_arenas[widget] = info->layer_arena;
+    }
+
+    info->daytime_arena = info->layer_arena;
+}
+
+static
+bool
+update_components(MainWindow* window,
+                  const cfg_changes_t* changes)
+{
+    window_info_t* info = get_info(window);
+    Layer* window_layer = window_get_root_layer(window);
+    bool layout_changed = cfg_changed(changes,
+                                      CFG_KEY_HOUR_POSITION) ||
+                          cfg_changed(changes,
+                                      CFG_KEY_MINUTES_POSITION) ||
+                          cfg_changed(changes,
+                                      CFG_KEY_BASE_LAYOUT);
+    bool created = false;
+
+    // Base watchface (hours/minutes)
+    if (layout_changed) {
+        move_layer(info->hours,
+                   layout_get_hour_offset());
+        move_layer(info->minutes,
+                   layout_get_minute_offset());
+    }
+
+    if (cfg_changed(changes,
+                    CFG_KEY_SKIP_DIGITS)) {
+        bool quick_wrap = cfg_get_skip_digits();
+        number_layer_set_quick_wrap(info->hours,
+                                    quick_wrap);
+        number_layer_set_quick_wrap(info->minutes,
+                                    quick_wrap);
+    }
+
+    if (cfg_changed(changes,
+                    CFG_KEY_ANIM_SPEED_NORMAL)) {
+        set_anim_speed(info,
+                       false);
+    }
+
+    // Widgets
+    // Rebuilt widgets take their data from the arena piece of the previous
+    // one, or with their layer if it does not fit
+#define WIDGETUPDATE(type, widget, position_key, style_key) \
+    do { \
+        bool active = layout_widget_is_active(widget); \
+        if (info->widget_##type && \
+            (!active || cfg_changed(changes, style_key))) { \
+            type##_layer_destroy(info->widget_##type); \
+            info->widget_##type = NULL; \
+        } \
+        if (info->widget_##type) { \
+            if (layout_changed || cfg_changed(changes, position_key)) { \
+                layer_set_frame(info->widget_##type, \
+                                layout_get_widget_area(widget)); \
+            } \
+        } else if (active) { \
+            arena_reset(&info->widget_arenas[widget]); \
+            layer_set_data_arena(&info->widget_arenas[widget]); \
+            info->widget_##type = type##_layer_create(); \
+            layer_set_data_arena(NULL); \
+            if (info->widget_##type) { \
+                layer_add_child(window_layer, \
+                                info->widget_##type); \
+                created = true; \
+            } \
+        } \
+    } while (false)
+    WIDGETUPDATE(seconds,
+                 WT_SECONDS,
+                 CFG_KEY_SECONDS_POSITION,
+                 CFG_KEY_SECONDS_STYLE);
+    WIDGETUPDATE(date,
+                 WT_DATE,
+                 CFG_KEY_DATE_POSITION,
+                 CFG_KEY_DATE_STYLE);
+    WIDGETUPDATE(bt,
+                 WT_BLUETOOTH,
+                 CFG_KEY_BLUETOOTH_POSITION,
+                 CFG_KEY_BLUETOOTH_STYLE);
+    WIDGETUPDATE(battery,
+                 WT_BATTERY,
+                 CFG_KEY_BATTERY_POSITION,
+                 CFG_KEY_BATTERY_STYLE);
+#undef WIDGETUPDATE
+
+    if (created ||
+        cfg_changed(changes,
+                    CFG_KEY_ANIM_SMOOTHNESS)) {
+        set_anim_step_count(info);
+    }
+
+    if (created ||
+        cfg_changed(changes,
+                    CFG_KEY_DISPLAY_WIDGETS)) {
+        set_widget_visibility(info,
+                              !layout_widgets_hidden());
+    }
+
+    // Extra widgets
+    if (cfg_changed(changes,
+                    CFG_KEY_DISPLAY_DAYTIME)) {
+        if (info->extrawidget_daytime) {
+            daytime_layer_destroy(info->extrawidget_daytime);
+        }
+
+        arena_reset(&info->daytime_arena);
+        layer_set_data_arena(&info->daytime_arena);
+        info->extrawidget_daytime = daytime_layer_create();
+        layer_set_data_arena(NULL);
+
+        if (info->extrawidget_daytime) {
+            layer_add_child(window_layer,
+                            info->extrawidget_daytime);
+            created = true;
+        }
+    } else if (layout_changed &&
+               info->extrawidget_daytime) {
+        daytime_layer_update_area(info->extrawidget_daytime);
+    }
+
+    if (created) {
+        restack_components(window);
+    }
+
+    if (cfg_changed(changes,
+                    CFG_KEY_INVERT_COLORS)) {
+        update_inverter(window);
+    }
+
+    return created;
+}
+
+static
+void
+restack_components(MainWindow* window)
+{
+    window_info_t* info = get_info(window);
+    Layer* window_layer = window_get_root_layer(window);
+    Layer* layers[] = {
+        info->widget_seconds,
+        info->widget_date,
+        info->widget_bt,
+        info->widget_battery,
+        info->extrawidget_daytime,
+        info->inverter
+        ? inverter_layer_get_layer(info->inverter)
+        : NULL
+    };
+
+    for (unsigned index = 0;
+         index < ARRAY_COUNT(layers);
+         ++index) {
+        if (layers[index]) {
+            layer_remove_from_parent(layers[index]);
+            layer_add_child(window_layer,
+                            layers[index]);
+        }
+    }
+}
+
+static
+void
+update_inverter(MainWindow* window)
+{
+    window_info_t* info = get_info(window);
+
+    if (info->inverter) {
+        heap_inverter_layer_destroy(HEAP_WINDOW,
+                                    info->inverter);
         info->inverter = NULL;
     }
+
+    if (layout_is_white_background()) {
+        info->inverter = heap_inverter_layer_create(HEAP_WINDOW,
+                                                    GRect(0,
+                                                          0,
+                                                          144,
+                                                          168));
+        layer_add_child(window_get_root_layer(window),
+                        inverter_layer_get_layer(info->inverter));
+    }
+}
+
+static
+void
+move_layer(Layer* layer,
+           GPoint origin)
+{
+    GRect frame = layer_get_frame(layer);
+    frame.origin = origin;
+    layer_set_frame(layer,
+                    frame);
 }
 
 static
@@ -396,6 +737,43 @@ set_anim_speed(window_info_t* info,
     }
 }
 
+static
+void
+set_anim_step_count(window_info_t* info)
+{
+    unsigned step_count = layout_anim_step_count();
+
+    if (info->hours) {
+        number_layer_set_step_count(info->hours,
+                                    step_count);
+        number_layer_set_step_count(info->minutes,
+                                    step_count);
+    }
+
+    if (info->widget_seconds) {
+        seconds_layer_set_step_count(info->widget_seconds,
+                                     step_count);
+    }
+}
+
+static
+void
+apply_governor_level(window_info_t* info)
+{
+    set_anim_step_count(info);
+
+    if (!governor_can_animate() && info->hours) {
+        number_layer_kill_anim(info->hours);
+        number_layer_kill_anim(info->minutes);
+
+        if (info->widget_seconds) {
+            seconds_layer_kill_anim(info->widget_seconds);
+        }
+
+        schedule_animation(info);
+    }
+}
+
 // SERVICES HANDLING =
 
 static
@@ -417,10 +795,9 @@ register_services(window_info_t* info)
         info->bt_service_registered = true;
     }
 
-    if (layout_widget_is_active(WT_BATTERY)) {
-        battery_state_service_subscribe(handle_battery);
-        info->battery_service_registered = true;
-    }
+    // Always needed by the governor
+    battery_state_service_subscribe(handle_battery);
+    info->battery_service_registered = true;
 }
 
 static
@@ -481,25 +858,20 @@ set_to_time(window_info_t* info,
             struct tm* tick_time,
             bool animate)
 {
-    int hours = tick_time->tm_hour;
+    int hours = get_display_hour(tick_time->tm_hour);
     int minutes = tick_time->tm_min;
     int seconds = tick_time->tm_sec;
 
-    if (!clock_is_24h_style()) {
-        if (hours > 12) {
-            hours -= 12;
-        } else if (hours == 0) {
-            hours = 12;
-        }
+    // Do not go back from a minute displayed ahead of time
+    if (!animate || get_time_ms() >= info->preroll_shown) {
+        number_layer_set_number(info->hours,
+                                hours,
+                                animate);
+        number_layer_set_number(info->minutes,
+                                minutes,
+                                animate);
     }
 
-    number_layer_set_number(info->hours,
-                            hours,
-                            animate);
-    number_layer_set_number(info->minutes,
-                            minutes,
-                            animate);
-
     if (are_widgets_visible(info)) {
         set_widget_to_time(info,
                            tick_time);
@@ -511,6 +883,7 @@ set_to_time(window_info_t* info,
     }
 
     schedule_animation(info);
+    schedule_preroll(info);
 
     if (seconds == 0 && can_vibrate(hours)) {
         switch (cfg_get_vibrate_every()) {
@@ -527,6 +900,21 @@ set_to_time(window_info_t* info,
     }
 }
 
+static
+int
+get_display_hour(int hour)
+{
+    if (!clock_is_24h_style()) {
+        if (hour > 12) {
+            hour -= 12;
+        } else if (hour == 0) {
+            hour = 12;
+        }
+    }
+
+    return hour;
+}
+
 static
 void
 set_widget_to_time(window_info_t* info,
@@ -563,23 +951,149 @@ animate_random(window_info_t* info)
                             false);
     number_layer_kill_anim(info->hours);
     number_layer_kill_anim(info->minutes);
+    info->preroll_shown = 0;
     set_to_current_time(info,
                         true);
     force_anim(info);
 }
 
 static
-void
+bool
 schedule_animation(window_info_t* info)
 {
-    if (!info->animation_timer) {
-        info->animation_timer =
-            app_timer_register(100,
-                               (AppTimerCallback) handle_anim_timer,
+    if (!info->hours) {
+        return false;
+    }
+
+    time_ms_t now = get_time_ms();
+    time_ms_t next_frame = TIME_MS_NEVER;
+    bool need_animation = false;
+    bool redrawn = false;
+
+    need_animation |= number_layer_animate(info->hours,
+                                           now,
+                                           &next_frame,
+                                           &redrawn);
+    need_animation |= number_layer_animate(info->minutes,
+                                           now,
+                                           &next_frame,
+                                           &redrawn);
+
+    if (info->widget_seconds) {
+        seconds_layer_animate(info->widget_seconds,
+                              now,
+                              &next_frame,
+                              &redrawn);
+    }
+
+    if (next_frame == TIME_MS_NEVER) {
+        if (info->animation_timer) {
+            app_timer_cancel(info->animation_timer);
+            info->animation_timer = NULL;
+        }
+    } else {
+        uint32_t delay = (uint32_t)(next_frame - now);
+
+        if (!info->animation_timer ||
+            !app_timer_reschedule(info->animation_timer,
+                                  delay)) {
+            info->animation_timer =
+                app_timer_register(delay,
+                                   (AppTimerCallback) handle_anim_timer,
+                                   info);
+        }
+    }
+
+#ifdef LOG_TIMINGS
+    // Time from the minute change to the end of the animation showing it
+    if (info->time_animated && !need_animation && !info->extra_animation) {
+        time_ms_t minute = (now + 30000) / 60000 * 60000;
+        APP_LOG(APP_LOG_LEVEL_DEBUG,
+                "time displayed %d ms after the minute change",
+                (int)(now - minute));
+    }
+
+    info->time_animated = need_animation;
+#endif
+
+    // Widget animation does not prevent extra_animation from being removed
+    if (!need_animation && info->extra_animation) {
+        info->extra_animation = false;
+        set_anim_speed(info,
+                       false);
+    }
+
+    return redrawn;
+}
+
+static
+void
+schedule_preroll(window_info_t* info)
+{
+    if (!cfg_get_anim_preroll() ||
+        !cfg_get_anim_on_time() ||
+        !governor_can_animate()) {
+        cancel_preroll(info);
+        return;
+    }
+
+    if (!info->preroll_timer) {
+        set_preroll_timer(info,
+                          (get_time_ms() / 60000 + 1) * 60000);
+    }
+}
+
+static
+void
+set_preroll_timer(window_info_t* info,
+                  time_ms_t minute)
+{
+    time_ms_t now = get_time_ms();
+    time_ms_t start = minute - get_preroll_duration(info,
+                                                    minute);
+    uint32_t delay = start > now
+                     ? (uint32_t)(start - now)
+                     : 0;
+    info->preroll_minute = minute;
+
+    if (!info->preroll_timer ||
+        !app_timer_reschedule(info->preroll_timer,
+                              delay)) {
+        info->preroll_timer =
+            app_timer_register(delay,
+                               (AppTimerCallback) handle_preroll_timer,
                                info);
     }
 }
 
+static
+void
+cancel_preroll(window_info_t* info)
+{
+    if (info->preroll_timer) {
+        app_timer_cancel(info->preroll_timer);
+        info->preroll_timer = NULL;
+    }
+}
+
+static
+uint32_t
+get_preroll_duration(window_info_t* info,
+                     time_ms_t minute)
+{
+    time_t seconds = minute / 1000;
+    struct tm* minute_time = localtime(&seconds);
+    uint32_t hours_duration =
+        number_layer_get_transition_ms(info->hours,
+                                       get_display_hour(minute_time->tm_hour));
+    uint32_t minutes_duration =
+        number_layer_get_transition_ms(info->minutes,
+                                       minute_time->tm_min);
+    return hours_duration > minutes_duration
+           ? hours_duration
+           : minutes_duration;
+}
+
 static
 void
 force_anim(window_info_t* info)
@@ -643,6 +1157,7 @@ handle_load(Window* window)
     window_set_background_color(window,
                                 GColorBlack);
     lay_components(window);
+    heap_log_usage("load");
 }
 
 static
@@ -652,7 +1167,11 @@ handle_appear(Window* window)
     window_info_t* info = get_info(window);
     register_services(info);
 
-    if (cfg_get_anim_on_load()) {
+    if (governor_update(battery_state_service_peek())) {
+        apply_governor_level(info);
+    }
+
+    if (cfg_get_anim_on_load() && governor_can_animate()) {
         animate_random(info);
     } else {
         set_to_current_time(info,
@@ -664,7 +1183,9 @@ static
 void
 handle_disappear(Window* window)
 {
-    unregister_services(get_info(window));
+    window_info_t* info = get_info(window);
+    unregister_services(info);
+    cancel_preroll(info);
 }
 
 static
@@ -681,7 +1202,7 @@ handle_time_tick(struct tm* tick_time,
 {
     set_to_time(get_info(NULL),
                 tick_time,
-                cfg_get_anim_on_time());
+                cfg_get_anim_on_time() && governor_can_animate());
 }
 
 static
@@ -691,7 +1212,7 @@ handle_accel_tap(AccelAxisType axis,
 {
     window_info_t* info = get_info(NULL);
 
-    if (cfg_get_anim_on_shake()) {
+    if (cfg_get_anim_on_shake() && governor_can_animate()) {
         animate_random(info);
     }
 
@@ -745,34 +1266,62 @@ handle_battery(BatteryChargeState charge)
                                 charge.is_plugged,
                                 charge.charge_percent);
     }
+
+    if (governor_update(charge)) {
+        apply_governor_level(info);
+    }
 }
 
 static
 void
 handle_anim_timer(window_info_t* info)
 {
-    bool need_animation = false;
-    bool widget_need_animation = false;
-
-    need_animation |= number_layer_animate(info->hours);
-    need_animation |= number_layer_animate(info->minutes);
+    info->animation_timer = NULL;
 
-    if (info->widget_seconds) {
-        widget_need_animation |= seconds_layer_animate(info->widget_seconds);
+    // The timer only fires at a frame deadline; wakeups whose frames were all
+    // dropped are not counted
+    if (schedule_animation(info)) {
+        governor_count_frame();
     }
+}
 
-    info->animation_timer = NULL;
+static
+void
+handle_preroll_timer(window_info_t* info)
+{
+    info->preroll_timer = NULL;
 
-    if (need_animation || widget_need_animation) {
-        schedule_animation(info);
+    // The battery level may have dropped since the timer was set; the minute
+    // tick then swaps the digits, and schedule_preroll() sets the timer again
+    // once animations are allowed
+    if (!governor_can_animate()) {
+        return;
     }
 
-    // Widget animation does not prevent extra_animation from being removed
-    if (!need_animation && info->extra_animation) {
-        info->extra_animation = false;
-        set_anim_speed(info,
-                       false);
+    time_ms_t minute = info->preroll_minute;
+    time_ms_t now = get_time_ms();
+    uint32_t duration = get_preroll_duration(info,
+                                             minute);
+
+    // Settings may have changed the animation since the timer was set
+    if (now + duration < minute) {
+        set_preroll_timer(info,
+                          minute);
+        return;
     }
+
+    time_t seconds = minute / 1000;
+    struct tm* minute_time = localtime(&seconds);
+    number_layer_set_number(info->hours,
+                            get_display_hour(minute_time->tm_hour),
+                            true);
+    number_layer_set_number(info->minutes,
+                            minute_time->tm_min,
+                            true);
+    info->preroll_shown = minute;
+    schedule_animation(info);
+    set_preroll_timer(info,
+                      minute + 60000);
 }
 
 // HELPER =
@@ -787,13 +1336,33 @@ info_init(window_info_t* info)
     info->widget_date = NULL;
     info->widget_bt = NULL;
     info->widget_battery = NULL;
+    info->extrawidget_daytime = NULL;
     info->inverter = NULL;
+    info->layer_arena.base = NULL;
+    info->layer_arena.size = 0;
+    info->layer_arena.used = 0;
+    info->layer_arena.tag = HEAP_LAYER_DATA;
+
+    for (unsigned widget = 0;
+         widget < WIDGET_TYPE_COUNT;
+         ++widget) {
+        info->widget_arenas[widget] = info->layer_arena;
+    }
+
+    info->daytime_arena = info->layer_arena;
     info->animation_timer = NULL;
+    info->preroll_timer = NULL;
+    info->preroll_minute = 0;
+    info->preroll_shown = 0;
     info->widget_timer = NULL;
     info->timer_service_registered = false;
     info->tap_service_registered = false;
     info->bt_service_registered = false;
+    info->battery_service_registered = false;
     info->extra_animation = false;
+#ifdef LOG_TIMINGS
+    info->time_animated = false;
+#endif
 }
 
 // ==============================
@@ -803,18 +1372,21 @@ info_init(window_info_t* info)
 MainWindow*
 main_window_create(void)
 {
+    size_t heap_begin = heap_track_begin();
     Window* result = window_create();
+    heap_track_end(HEAP_WINDOW,
+                   heap_begin);
     window_set_window_handlers(result, (WindowHandlers) {
         .load = handle_load,
          .appear = handle_appear,
           .disappear = handle_disappear,
            .unload = handle_unload
     });
-    window_info_t* info = malloc(sizeof(window_info_t));
+    window_info_t* info = heap_malloc(HEAP_WINDOW,
+                                      sizeof(window_info_t));
     info_init(info);
     window_set_user_data(result, info);
     global_main_window = result;
-    schedule_animation(info);
     return result;
 }
 
@@ -822,17 +1394,49 @@ void
 main_window_destroy(MainWindow* window)
 {
     window_info_t* info = get_info(window);
-    free(info);
+    // The unload handler still needs the window state
+    size_t heap_begin = heap_track_begin();
     window_destroy(window);
+    heap_track_end(HEAP_WINDOW,
+                   heap_begin);
+    heap_free(HEAP_WINDOW,
+              info);
 }
 
 void
-main_window_update_settings(MainWindow* window)
+main_window_update_settings(MainWindow* window,
+                            const cfg_changes_t* changes)
 {
-    lay_components(window);
     window_info_t* info = get_info(window);
-    set_to_current_time(info,
-                        false);
+
+    // Components are laid out with the current settings when the window loads
+    if (!info->hours) {
+        return;
+    }
+
+#ifdef LOG_TIMINGS
+    time_ms_t start = get_time_ms();
+#endif
+
+    if (update_components(window,
+                          changes)) {
+        set_to_current_time(info,
+                            false);
+    }
+
+    if (cfg_changed(changes,
+                    CFG_KEY_ANIM_PREROLL) ||
+        cfg_changed(changes,
+                    CFG_KEY_ANIM_ON_TIME)) {
+        schedule_preroll(info);
+    }
+
     register_services(info);
+#ifdef LOG_TIMINGS
+    APP_LOG(APP_LOG_LEVEL_DEBUG,
+            "settings applied in %lu ms",
+            (unsigned long) (get_time_ms() - start));
+    heap_log_usage("settings");
+#endif
 }
 
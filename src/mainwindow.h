@@ -12,6 +12,8 @@
 
 #include <pebble.h>
 
+#include "config.h"
+
 // =======
 // TYPES =
 // =======
@@ -31,9 +33,14 @@ main_window_create(void);
 void
 main_window_destroy(MainWindow* window);
 
-/** Update the window layout with user settings. */
+/** Update the window layout with user settings.
+ *
+ * @param changes Settings changed since the last update; only the components
+ * they affect are rebuilt
+ */
 void
-main_window_update_settings(MainWindow* window);
+main_window_update_settings(MainWindow* window,
+                            const cfg_changes_t* changes);
 
 #endif
 
@@ -11,30 +11,340 @@
 
 #include "utils.h"
 
+// ================
+// PRIVATE CONSTS =
+// ================
+
+/** Masks of the n lowest bits of a bitmap word, for n in [0, 32].
+ *
+ * Bitmaps are 1bpp with the leftmost pixel in the lowest bit, and rows are
+ * word aligned, so a word covers 32 consecutive pixels of a row.
+ */
+static
+const uint32_t low_bits_mask[33] = {
+    0x00000000u, 0x00000001u, 0x00000003u, 0x00000007u,
+    0x0000000fu, 0x0000001fu, 0x0000003fu, 0x0000007fu,
+    0x000000ffu, 0x000001ffu, 0x000003ffu, 0x000007ffu,
+    0x00000fffu, 0x00001fffu, 0x00003fffu, 0x00007fffu,
+    0x0000ffffu, 0x0001ffffu, 0x0003ffffu, 0x0007ffffu,
+    0x000fffffu, 0x001fffffu, 0x003fffffu, 0x007fffffu,
+    0x00ffffffu, 0x01ffffffu, 0x03ffffffu, 0x07ffffffu,
+    0x0fffffffu, 0x1fffffffu, 0x3fffffffu, 0x7fffffffu,
+    0xffffffffu
+};
+
+// ===================
+// PRIVATE VARIABLES =
+// ===================
+
+/** Arena of the layers custom data (NULL if none) */
+static
+arena_t* layer_data_arena = NULL;
+
+// ================================
+// PRIVATE FUNCTIONS DECLARATIONS =
+// ================================
+
+/** Set all the pixels of an area of a bitmap to the same color.
+ *
+ * @param rect The area to set, relative to the bitmap bounds
+ * @param white true to set pixels to white, false to set them to black
+ */
+static
+void
+set_rect(GBitmap* target,
+         GRect rect,
+         bool white);
+
+// ===============================
+// PRIVATE FUNCTIONS DEFINITIONS =
+// ===============================
+
+static
+void
+set_rect(GBitmap* target,
+         GRect rect,
+         bool white)
+{
+    if (rect_is_empty(rect)) {
+        return;
+    }
+
+    int left = target->bounds.origin.x + rect.origin.x;
+    int right = left + rect.size.w;
+    int top = target->bounds.origin.y + rect.origin.y;
+    unsigned first_word = left >> 5;
+    unsigned last_word = (right - 1) >> 5;
+    uint32_t first_mask = ~low_bits_mask[left & 31];
+    uint32_t last_mask = low_bits_mask[((right - 1) & 31) + 1];
+    uint32_t fill = white ? 0xffffffffu : 0;
+
+    if (first_word == last_word) {
+        first_mask &= last_mask;
+    }
+
+    for (int y = top;
+         y < top + rect.size.h;
+         ++y) {
+        uint32_t* row = (uint32_t*) ((uint8_t*) target->addr +
+                                     y * target->row_size_bytes);
+        row[first_word] = (row[first_word] & ~first_mask) |
+                          (fill & first_mask);
+
+        if (first_word == last_word) {
+            continue;
+        }
+
+        for (unsigned word = first_word + 1;
+             word < last_word;
+             ++word) {
+            row[word] = fill;
+        }
+
+        row[last_word] = (row[last_word] & ~last_mask) | (fill & last_mask);
+    }
+}
+
 // ==============================
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+time_ms_t
+get_time_ms(void)
+{
+    time_t seconds;
+    uint16_t milliseconds = time_ms(&seconds,
+                                    NULL);
+    return ((time_ms_t) seconds) * 1000 + milliseconds;
+}
+
+bool
+arena_create(arena_t* arena,
+             heap_tag_t tag,
+             size_t size)
+{
+    arena->base = heap_malloc(tag,
+                              size);
+    arena->size = arena->base ? size : 0;
+    arena->used = 0;
+    arena->tag = tag;
+    return arena->base != NULL;
+}
+
+void*
+arena_alloc(arena_t* arena,
+            size_t size)
+{
+    size_t piece_size = arena_piece_size(size);
+
+    if (piece_size > arena->size - arena->used) {
+        return NULL;
+    }
+
+    void* result = arena->base + arena->used;
+    arena->used += piece_size;
+    return result;
+}
+
+void
+arena_split(arena_t* arena,
+            arena_t* piece,
+            size_t size)
+{
+    piece->base = arena_alloc(arena,
+                              size);
+    piece->size = piece->base ? arena_piece_size(size) : 0;
+    piece->used = 0;
+    piece->tag = arena->tag;
+}
+
+void
+arena_reset(arena_t* arena)
+{
+    arena->used = 0;
+}
+
 void
-load_bitmap_into_array_from_id(const ResourceId* resource_ids,
-                               GBitmap* target_array[],
-                               unsigned resources_count)
+arena_release(arena_t* arena)
 {
-    for (unsigned index = 0;
-         index < resources_count;
-         ++index) {
-        target_array[index] = gbitmap_create_with_resource(resource_ids[index]);
+    if (arena->base) {
+        heap_free(arena->tag,
+                  arena->base);
     }
+
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
+void
+layer_set_data_arena(arena_t* arena)
+{
+    layer_data_arena = arena;
 }
 
 Layer*
-layer_create_with_init_data(GRect layer_rect,
+layer_create_with_init_data(heap_tag_t tag,
+                            GRect layer_rect,
                             size_t data_size,
                             layer_data_init_t layer_data_init)
 {
-    Layer* result = layer_create_with_data(layer_rect,
-                                           data_size);
-    layer_data_init(layer_get_data(result));
+    // The layer only holds a pointer to its data, taken from the arena or
+    // allocated right after the pointer
+    void* data = layer_data_arena
+                 ? arena_alloc(layer_data_arena,
+                               data_size)
+                 : NULL;
+    Layer* result = heap_layer_create_with_data(tag,
+                                                layer_rect,
+                                                sizeof(void*) +
+                                                (data ? 0 : data_size));
+
+    if (!result) {
+        return NULL;
+    }
+
+    void** data_pointer = layer_get_data(result);
+
+    if (!data) {
+        data = data_pointer + 1;
+    }
+
+    *data_pointer = data;
+    layer_data_init(data);
     return result;
 }
 
+GRect
+rect_union(GRect first,
+           GRect second)
+{
+    if (rect_is_empty(first)) {
+        return second;
+    }
+
+    if (rect_is_empty(second)) {
+        return first;
+    }
+
+    int left = first.origin.x < second.origin.x
+               ? first.origin.x
+               : second.origin.x;
+    int top = first.origin.y < second.origin.y
+              ? first.origin.y
+              : second.origin.y;
+    int first_right = first.origin.x + first.size.w;
+    int second_right = second.origin.x + second.size.w;
+    int first_bottom = first.origin.y + first.size.h;
+    int second_bottom = second.origin.y + second.size.h;
+    int right = first_right > second_right ? first_right : second_right;
+    int bottom = first_bottom > second_bottom ? first_bottom : second_bottom;
+    return GRect(left, top,
+                 right - left, bottom - top);
+}
+
+GRect
+rect_intersection(GRect first,
+                  GRect second)
+{
+    int left = first.origin.x > second.origin.x
+               ? first.origin.x
+               : second.origin.x;
+    int top = first.origin.y > second.origin.y
+              ? first.origin.y
+              : second.origin.y;
+    int first_right = first.origin.x + first.size.w;
+    int second_right = second.origin.x + second.size.w;
+    int first_bottom = first.origin.y + first.size.h;
+    int second_bottom = second.origin.y + second.size.h;
+    int right = first_right < second_right ? first_right : second_right;
+    int bottom = first_bottom < second_bottom ? first_bottom : second_bottom;
+
+    if (right <= left || bottom <= top) {
+        return GRectZero;
+    }
+
+    return GRect(left, top,
+                 right - left, bottom - top);
+}
+
+void
+bitmap_clear_rect(GBitmap* target,
+                  GRect rect)
+{
+    set_rect(target,
+             rect,
+             false);
+}
+
+void
+bitmap_fill_rect(GBitmap* target,
+                 GRect rect)
+{
+    set_rect(target,
+             rect,
+             true);
+}
+
+void
+bitmap_or_bitmap(GBitmap* target,
+                 const GBitmap* source,
+                 GPoint origin,
+                 GRect clip)
+{
+    GRect area = rect_intersection(GRect(origin.x, origin.y,
+                                         source->bounds.size.w,
+                                         source->bounds.size.h),
+                                   clip);
+
+    if (rect_is_empty(area)) {
+        return;
+    }
+
+    int source_left = source->bounds.origin.x + area.origin.x - origin.x;
+    int target_left = target->bounds.origin.x + area.origin.x;
+    const uint8_t* source_row = (const uint8_t*) source->addr +
+                                (source->bounds.origin.y + area.origin.y -
+                                 origin.y) *
+                                source->row_size_bytes;
+    uint8_t* target_row = (uint8_t*) target->addr +
+                          (target->bounds.origin.y + area.origin.y) *
+                          target->row_size_bytes;
+
+    for (int y = 0;
+         y < area.size.h;
+         ++y) {
+        const uint32_t* source_words = (const uint32_t*) source_row;
+        uint32_t* target_words = (uint32_t*) target_row;
+
+        // Move up to 32 pixels at a time: extract them from the source row,
+        // then OR them in one or two target words
+        for (int x = 0;
+             x < area.size.w;
+             x += 32) {
+            int count = area.size.w - x < 32 ? area.size.w - x : 32;
+            unsigned source_x = source_left + x;
+            unsigned source_word = source_x >> 5;
+            unsigned source_shift = source_x & 31;
+            uint32_t bits = source_words[source_word] >> source_shift;
+
+            if (source_shift && source_shift + count > 32) {
+                bits |= source_words[source_word + 1] << (32 - source_shift);
+            }
+
+            bits &= low_bits_mask[count];
+
+            unsigned target_x = target_left + x;
+            unsigned target_word = target_x >> 5;
+            unsigned target_shift = target_x & 31;
+            target_words[target_word] |= bits << target_shift;
+
+            if (target_shift && target_shift + count > 32) {
+                target_words[target_word + 1] |= bits >> (32 - target_shift);
+            }
+        }
+
+        source_row += source->row_size_bytes;
+        target_row += target->row_size_bytes;
+    }
+}
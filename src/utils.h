@@ -12,6 +12,8 @@
 
 #include <pebble.h>
 
+#include "heap.h"
+
 // =======
 // TYPES =
 // =======
@@ -19,28 +21,189 @@
 /** Layer custom-data initialization function */
 typedef void(*layer_data_init_t)(void* data);
 
+/** Wall clock time, in milliseconds */
+typedef uint64_t time_ms_t;
+
+/** A single heap block, handed out in pieces and released at once */
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    /** Subsystem the block is accounted to */
+    heap_tag_t tag;
+} arena_t;
+
+// ========
+// CONSTS =
+// ========
+
+/** A deadline that is never reached */
+#define TIME_MS_NEVER UINT64_MAX
+
+/** Alignment of the pieces of an arena */
+#define ARENA_ALIGNMENT 8
+
+// ========
+// MACROS =
+// ========
+
+/** Number of elements of an array */
+#define ARRAY_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+/** Fail the build if a constant expression is false.
+ *
+ * Usable at file scope. name must be unique in the translation unit, and is
+ * part of the compiler error message.
+ */
+#define STATIC_ASSERT(condition, name) \
+    typedef char static_assert_##name[(condition) ? 1 : -1]
+
 // ===============================
 // PUBLIC FUNCTIONS DECLARATIONS =
 // ===============================
 
-/** Load a list of resource identifier into an array of bitmaps.
+/** Return the current wall clock time, in milliseconds. */
+time_ms_t
+get_time_ms(void);
+
+/** Allocate the block of an arena.
  *
- * The target array must already be initialized.
+ * @param size Total size of the pieces, each rounded with arena_piece_size()
+ * @return false if the block could not be allocated; the arena is then empty
+ * and every arena_alloc() fails
+ */
+bool
+arena_create(arena_t* arena,
+             heap_tag_t tag,
+             size_t size);
+
+/** Return the room taken in an arena by a piece of a given size. */
+static inline
+size_t
+arena_piece_size(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+/** Take a piece of an arena.
+ *
+ * @return NULL if the arena is full
+ */
+void*
+arena_alloc(arena_t* arena,
+            size_t size);
+
+/** Take a piece of an arena, to hand it out in pieces as an arena of its own.
  *
- * @param resource_ids A list of resource id to load
- * @param target_array The bitmap array to fill
- * @param resources_count The number of resources to load
+ * The piece is released with the arena it was taken from, and must not be
+ * released itself. If the arena is full, the piece is an empty arena.
  */
 void
-load_bitmap_into_array_from_id(const ResourceId* resource_ids,
-                               GBitmap* target_array[],
-                               unsigned resources_count);
+arena_split(arena_t* arena,
+            arena_t* piece,
+            size_t size);
 
-/** Create a layer with initialized custom data. */
+/** Give back all the pieces taken from an arena, and keep its block.
+ *
+ * The pieces must not be used anymore.
+ */
+void
+arena_reset(arena_t* arena);
+
+/** Release the block of an arena, and all the pieces taken from it. */
+void
+arena_release(arena_t* arena);
+
+/** Set the arena holding the custom data of the layers created from now on.
+ *
+ * With no arena (NULL), or once the arena is full, the custom data is
+ * allocated with the layer.
+ */
+void
+layer_set_data_arena(arena_t* arena);
+
+/** Create a layer with initialized custom data.
+ *
+ * The custom data is taken from the current layer data arena if possible, and
+ * retrieved with layer_get_init_data(). In the arena, it takes
+ * arena_piece_size(data_size) bytes.
+ *
+ * @param tag Subsystem the layer is accounted to
+ */
 Layer*
-layer_create_with_init_data(GRect layer_rect,
+layer_create_with_init_data(heap_tag_t tag,
+                            GRect layer_rect,
                             size_t data_size,
                             layer_data_init_t layer_data_init);
 
+/** Return the custom data of a layer created with
+ * layer_create_with_init_data().
+ */
+static inline
+void*
+layer_get_init_data(const Layer* layer)
+{
+    return *(void**) layer_get_data(layer);
+}
+
+/** Return true if a rectangle covers no pixel. */
+static inline
+bool
+rect_is_empty(GRect rect)
+{
+    return rect.size.w <= 0 || rect.size.h <= 0;
+}
+
+/** Return the smallest rectangle containing both rectangles.
+ *
+ * Empty rectangles are ignored.
+ */
+GRect
+rect_union(GRect first,
+           GRect second);
+
+/** Return the intersection of two rectangles.
+ *
+ * The result is empty if they do not overlap.
+ */
+GRect
+rect_intersection(GRect first,
+                  GRect second);
+
+/** Clear (set to black) an area of a bitmap.
+ *
+ * @param rect The area to clear, relative to the bitmap bounds. It must be
+ * inside the bitmap.
+ */
+void
+bitmap_clear_rect(GBitmap* target,
+                  GRect rect);
+
+/** Fill (set to white) an area of a bitmap.
+ *
+ * @param rect The area to fill, relative to the bitmap bounds. It must be
+ * inside the bitmap.
+ */
+void
+bitmap_fill_rect(GBitmap* target,
+                 GRect rect);
+
+/** Draw a bitmap into another bitmap, with GCompOpOr compositing.
+ *
+ * This is the equivalent of graphics_draw_bitmap_in_rect() for offscreen
+ * bitmaps, without tiling. Pixels are moved 32 at a time, using the word
+ * alignment of bitmap rows; segment bitmaps (at most 34 pixels wide) take one
+ * or two words per row.
+ *
+ * @param origin Placement of the source in the target
+ * @param clip Only pixels in this area of the target are written. It must be
+ * inside the target bitmap.
+ */
+void
+bitmap_or_bitmap(GBitmap* target,
+                 const GBitmap* source,
+                 GPoint origin,
+                 GRect clip);
+
 #endif
 
@@ -7,6 +7,7 @@
 
 #include <pebble.h>
 
+#include "heap.h"
 #include "layout.h"
 #include "utils.h"
 
@@ -40,7 +41,7 @@ static const unsigned plug_height = 16;
 static inline
 battery_info_t* get_info(BatteryLayer* layer)
 {
-    return (battery_info_t*) layer_get_data(layer);
+    return (battery_info_t*) layer_get_init_data(layer);
 }
 
 static
@@ -138,6 +139,14 @@ handle_layer_update(Layer* layer,
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+size_t
+battery_layer_get_data_size(void)
+{
+    return layout_widget_is_active(WT_BATTERY)
+           ? arena_piece_size(sizeof(battery_info_t))
+           : 0;
+}
+
 BatteryLayer*
 battery_layer_create(void)
 {
@@ -146,7 +155,8 @@ battery_layer_create(void)
     }
 
     BatteryLayer* result =
-        layer_create_with_init_data(layout_get_widget_area(WT_BATTERY),
+        layer_create_with_init_data(HEAP_WIDGETS,
+                                    layout_get_widget_area(WT_BATTERY),
                                     sizeof(battery_info_t),
                                     (layer_data_init_t) info_init);
     layer_set_update_proc(result,
@@ -154,15 +164,18 @@ battery_layer_create(void)
     battery_info_t* info = get_info(result);
 
     info->batt_plug =
-        gbitmap_create_with_resource(RESOURCE_ID_BATT_PLUG);
+        heap_gbitmap_create_with_resource(HEAP_WIDGETS,
+                                          RESOURCE_ID_BATT_PLUG);
 
     if (cfg_get_battery_style() == BATTERY_STYLE_STATE) {
         info->batt_border =
-            gbitmap_create_with_resource(RESOURCE_ID_BATT_CONTOUR);
+            heap_gbitmap_create_with_resource(HEAP_WIDGETS,
+                                              RESOURCE_ID_BATT_CONTOUR);
     } else {
         info->font = fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD);
         info->batt_border =
-            gbitmap_create_with_resource(RESOURCE_ID_BATT_TEXTIMG);
+            heap_gbitmap_create_with_resource(HEAP_WIDGETS,
+                                              RESOURCE_ID_BATT_TEXTIMG);
     }
 
     BatteryChargeState batt_state = battery_state_service_peek();
@@ -232,12 +245,15 @@ battery_layer_destroy(BatteryLayer* layer)
 {
     battery_info_t* info = get_info(layer);
 
-    gbitmap_destroy(info->batt_plug);
+    heap_gbitmap_destroy(HEAP_WIDGETS,
+                         info->batt_plug);
 
     if (info->batt_border) {
-        gbitmap_destroy(info->batt_border);
+        heap_gbitmap_destroy(HEAP_WIDGETS,
+                             info->batt_border);
     }
 
-    layer_destroy(layer);
+    heap_layer_destroy(HEAP_WIDGETS,
+                       layer);
 }
 
@@ -23,12 +23,20 @@ typedef Layer BatteryLayer;
 BatteryLayer*
 battery_layer_create(void);
 
+/** Return the room taken in the layer data arena by the layer.
+ *
+ * This take all settings from the configuration. Return 0 if the layer is not
+ * enabled.
+ */
+size_t
+battery_layer_get_data_size(void);
+
 void
 battery_layer_set_state(BatteryLayer* layer,
                         bool charging,
                         uint8_t charge_percent);
 
-inline
+static inline
 void
 battery_layer_set_hidden(BatteryLayer* layer,
                          bool hidden)
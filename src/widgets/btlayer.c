@@ -8,6 +8,7 @@
 #include <pebble.h>
 
 #include "config.h"
+#include "heap.h"
 #include "layout.h"
 #include "utils.h"
 
@@ -44,7 +45,7 @@ const GPoint image_offset = {9, 6};
 static inline
 bt_info_t* get_info(BtLayer* layer)
 {
-    return (bt_info_t*) layer_get_data(layer);
+    return (bt_info_t*) layer_get_init_data(layer);
 }
 
 static
@@ -167,6 +168,14 @@ handle_layer_update(struct Layer* layer,
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+size_t
+bt_layer_get_data_size(void)
+{
+    return layout_widget_is_active(WT_BLUETOOTH)
+           ? arena_piece_size(sizeof(bt_info_t))
+           : 0;
+}
+
 BtLayer*
 bt_layer_create(void)
 {
@@ -175,14 +184,17 @@ bt_layer_create(void)
     }
 
     BtLayer* result =
-        layer_create_with_init_data(layout_get_widget_area(WT_BLUETOOTH),
+        layer_create_with_init_data(HEAP_WIDGETS,
+                                    layout_get_widget_area(WT_BLUETOOTH),
                                     sizeof(bt_info_t),
                                     (layer_data_init_t) info_init);
     layer_set_update_proc(result,
                           handle_layer_update);
     bt_info_t* info = get_info(result);
-    info->image_on = gbitmap_create_with_resource(RESOURCE_ID_BT_ON);
-    info->image_off = gbitmap_create_with_resource(RESOURCE_ID_BT_OFF);
+    info->image_on = heap_gbitmap_create_with_resource(HEAP_WIDGETS,
+                                                       RESOURCE_ID_BT_ON);
+    info->image_off = heap_gbitmap_create_with_resource(HEAP_WIDGETS,
+                                                        RESOURCE_ID_BT_OFF);
     info->bt_state = bluetooth_connection_service_peek();
     return result;
 }
@@ -222,8 +234,11 @@ void
 bt_layer_destroy(BtLayer* layer)
 {
     bt_info_t* info = get_info(layer);
-    gbitmap_destroy(info->image_on);
-    gbitmap_destroy(info->image_off);
-    layer_destroy(layer);
+    heap_gbitmap_destroy(HEAP_WIDGETS,
+                         info->image_on);
+    heap_gbitmap_destroy(HEAP_WIDGETS,
+                         info->image_off);
+    heap_layer_destroy(HEAP_WIDGETS,
+                       layer);
 }
 
@@ -30,6 +30,14 @@ typedef Layer BtLayer;
 BtLayer*
 bt_layer_create(void);
 
+/** Return the room taken in the layer data arena by the layer.
+ *
+ * This take all settings from the configuration. Return 0 if the layer is not
+ * enabled.
+ */
+size_t
+bt_layer_get_data_size(void);
+
 /** Change the displayed state of the Bluetooth. */
 void
 bt_layer_set_state(BtLayer* layer,
@@ -7,6 +7,7 @@
 
 #include <pebble.h>
 
+#include "heap.h"
 #include "utils.h"
 #include "config.h"
 #include "layout.h"
@@ -34,7 +35,7 @@ static inline
 date_info_t*
 get_info(DateLayer* layer)
 {
-    return (date_info_t*) layer_get_data(layer);
+    return (date_info_t*) layer_get_init_data(layer);
 }
 
 /** Initialize the state */
@@ -60,6 +61,14 @@ info_init(date_info_t* info)
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+size_t
+date_layer_get_data_size(void)
+{
+    return layout_widget_is_active(WT_DATE)
+           ? arena_piece_size(sizeof(date_info_t))
+           : 0;
+}
+
 DateLayer*
 date_layer_create(void)
 {
@@ -68,7 +77,8 @@ date_layer_create(void)
     }
 
     DateLayer* result =
-        layer_create_with_init_data(layout_get_widget_area(WT_DATE),
+        layer_create_with_init_data(HEAP_WIDGETS,
+                                    layout_get_widget_area(WT_DATE),
                                     sizeof(date_info_t),
                                     (layer_data_init_t) info_init);
     date_info_t* info = get_info(result);
@@ -92,8 +102,10 @@ date_layer_create(void)
     switch (cfg_get_date_style()) {
     default:
     case DATE_STYLE_DAYFIRST:
-        info->day_text = text_layer_create(top_rect);
-        info->month_text = text_layer_create(bottom_rect);
+        info->day_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                top_rect);
+        info->month_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                  bottom_rect);
         text_layer_set_font(info->day_text,
                             fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD));
         text_layer_set_font(info->month_text,
@@ -101,14 +113,17 @@ date_layer_create(void)
         break;
 
     case DATE_STYLE_DAYONLY:
-        info->day_text = text_layer_create(big_rect);
+        info->day_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                big_rect);
         text_layer_set_font(info->day_text,
                             fonts_get_system_font(FONT_KEY_GOTHIC_28_BOLD));
         break;
 
     case DATE_STYLE_MONFIRST:
-        info->day_text = text_layer_create(bottom_rect);
-        info->month_text = text_layer_create(top_rect);
+        info->day_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                bottom_rect);
+        info->month_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                  top_rect);
         text_layer_set_font(info->day_text,
                             fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD));
         text_layer_set_font(info->month_text,
@@ -116,7 +131,8 @@ date_layer_create(void)
         break;
 
     case DATE_STYLE_MONONLY:
-        info->month_text = text_layer_create(big_rect);
+        info->month_text = heap_text_layer_create(HEAP_WIDGETS,
+                                                  big_rect);
         text_layer_set_font(info->month_text,
                             fonts_get_system_font(FONT_KEY_GOTHIC_28_BOLD));
     }
@@ -178,13 +194,16 @@ date_layer_destroy(DateLayer* layer)
     date_info_t* info = get_info(layer);
 
     if (info->day_text) {
-        text_layer_destroy(info->day_text);
+        heap_text_layer_destroy(HEAP_WIDGETS,
+                                info->day_text);
     }
 
     if (info->month_text) {
-        text_layer_destroy(info->month_text);
+        heap_text_layer_destroy(HEAP_WIDGETS,
+                                info->month_text);
     }
 
-    layer_destroy(layer);
+    heap_layer_destroy(HEAP_WIDGETS,
+                       layer);
 }
 
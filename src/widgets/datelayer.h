@@ -31,13 +31,21 @@ typedef Layer DateLayer;
 DateLayer*
 date_layer_create(void);
 
+/** Return the room taken in the layer data arena by the layer.
+ *
+ * This take all settings from the configuration. Return 0 if the layer is not
+ * enabled.
+ */
+size_t
+date_layer_get_data_size(void);
+
 /** Set the date */
 void
 date_layer_set_date(DateLayer* layer,
                     unsigned day,
                     unsigned month);
 
-inline
+static inline
 void
 date_layer_set_hidden(DateLayer* layer,
                       bool hidden)
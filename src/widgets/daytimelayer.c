@@ -8,6 +8,7 @@
 #include <pebble.h>
 
 #include "config.h"
+#include "heap.h"
 #include "layout.h"
 #include "digits/digit_info.h"
 #include "utils.h"
@@ -30,13 +31,23 @@ typedef struct {
 static inline
 daytime_info_t* get_info(DayTimeLayer* layer)
 {
-    return (daytime_info_t*) layer_get_data(layer);
+    return (daytime_info_t*) layer_get_init_data(layer);
 }
 
 static
 void
 info_init(daytime_info_t* info);
 
+/** Return true if the layer is enabled in the configuration */
+static
+bool
+is_displayed(void);
+
+/** Return the area of the layer, next to the hour */
+static
+GRect
+get_area(void);
+
 // ===============================
 // PRIVATE FUNCTIONS DEFINITIONS =
 // ===============================
@@ -51,24 +62,46 @@ info_init(daytime_info_t* info)
     info->text[2] = '\0';
 }
 
+static
+bool
+is_displayed(void)
+{
+    return cfg_get_display_daytime() && !clock_is_24h_style();
+}
+
+static
+GRect
+get_area(void)
+{
+    GRect result;
+    result.origin = layout_get_hour_offset();
+    result.origin.x += 62;
+    result.origin.y += 63;
+    result.size = GSize(24, 9);
+    return result;
+}
+
 // ==============================
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+size_t
+daytime_layer_get_data_size(void)
+{
+    return is_displayed() ? arena_piece_size(sizeof(daytime_info_t)) : 0;
+}
+
 DayTimeLayer*
 daytime_layer_create(void)
 {
-    if (!cfg_get_display_daytime() || clock_is_24h_style()) {
+    if (!is_displayed()) {
         return NULL;
     }
 
-    GRect layer_rect;
-    layer_rect.origin = layout_get_hour_offset();
-    layer_rect.origin.x += 62;
-    layer_rect.origin.y += 63;
-    layer_rect.size = GSize(24, 9);
+    GRect layer_rect = get_area();
     DayTimeLayer* result =
-        layer_create_with_init_data(layer_rect,
+        layer_create_with_init_data(HEAP_WIDGETS,
+                                    layer_rect,
                                     sizeof(daytime_info_t),
                                     (layer_data_init_t) info_init);
     daytime_info_t* info = get_info(result);
@@ -76,7 +109,8 @@ daytime_layer_create(void)
     layer_rect.origin.x = 0;
     layer_rect.origin.y = -text_vertical_offset;
     layer_rect.size.h += text_vertical_offset;
-    info->text_layer = text_layer_create(layer_rect);
+    info->text_layer = heap_text_layer_create(HEAP_WIDGETS,
+                                              layer_rect);
     text_layer_set_font(info->text_layer,
                         fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD));
     text_layer_set_text_alignment(info->text_layer,
@@ -90,6 +124,13 @@ daytime_layer_create(void)
     return result;
 }
 
+void
+daytime_layer_update_area(DayTimeLayer* layer)
+{
+    layer_set_frame(layer,
+                    get_area());
+}
+
 void
 daytime_layer_set_time(DayTimeLayer* layer,
                        struct tm* tick_time)
@@ -106,7 +147,9 @@ void
 daytime_layer_destroy(DayTimeLayer* layer)
 {
     daytime_info_t* info = get_info(layer);
-    text_layer_destroy(info->text_layer);
-    layer_destroy(layer);
+    heap_text_layer_destroy(HEAP_WIDGETS,
+                            info->text_layer);
+    heap_layer_destroy(HEAP_WIDGETS,
+                       layer);
 }
 
@@ -23,6 +23,18 @@ typedef Layer DayTimeLayer;
 DayTimeLayer*
 daytime_layer_create(void);
 
+/** Return the room taken in the layer data arena by the layer.
+ *
+ * This take all settings from the configuration. Return 0 if the layer is not
+ * enabled.
+ */
+size_t
+daytime_layer_get_data_size(void);
+
+/** Move the layer next to the hour, after a layout change. */
+void
+daytime_layer_update_area(DayTimeLayer* layer);
+
 void
 daytime_layer_set_time(DayTimeLayer* layer,
         struct tm* tick_time);
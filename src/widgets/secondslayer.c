@@ -9,8 +9,10 @@
 
 #include "digits/numberlayer.h"
 #include "digits/digit_info.h"
+#include "heap.h"
 #include "layout.h"
 #include "config.h"
+#include "governor.h"
 #include "utils.h"
 
 #include "secondslayer.h"
@@ -40,7 +42,7 @@ static inline
 seconds_info_t*
 get_info(SecondsLayer* layer)
 {
-    return (seconds_info_t*) layer_get_data(layer);
+    return (seconds_info_t*) layer_get_init_data(layer);
 }
 
 // ===============================
@@ -60,6 +62,22 @@ info_init(seconds_info_t* info)
 // PUBLIC FUNCTIONS DEFINITIONS =
 // ==============================
 
+size_t
+seconds_layer_get_data_size(void)
+{
+    if (!layout_widget_is_active(WT_SECONDS)) {
+        return 0;
+    }
+
+    size_t result = arena_piece_size(sizeof(seconds_info_t));
+
+    if (cfg_get_seconds_style() != SECONDS_STYLE_DOT) {
+        result += number_layer_get_data_size(2);
+    }
+
+    return result;
+}
+
 SecondsLayer*
 seconds_layer_create(void)
 {
@@ -68,7 +86,8 @@ seconds_layer_create(void)
     }
 
     SecondsLayer* result =
-        layer_create_with_init_data(layout_get_widget_area(WT_SECONDS),
+        layer_create_with_init_data(HEAP_WIDGETS,
+                                    layout_get_widget_area(WT_SECONDS),
                                     sizeof(seconds_info_t),
                                     (layer_data_init_t) info_init);
     seconds_info_t* info = get_info(result);
@@ -78,7 +97,8 @@ seconds_layer_create(void)
                                widget_size / 2 - seconds_dot_size / 2,
                                seconds_dot_size,
                                seconds_dot_size);
-        info->inverter_layer = inverter_layer_create(dot_rect);
+        info->inverter_layer = heap_inverter_layer_create(HEAP_WIDGETS,
+                                                          dot_rect);
         layer_add_child(result,
                         inverter_layer_get_layer(info->inverter_layer));
     } else {
@@ -97,7 +117,10 @@ seconds_layer_create(void)
 }
 
 bool
-seconds_layer_animate(SecondsLayer* layer)
+seconds_layer_animate(SecondsLayer* layer,
+                      time_ms_t now,
+                      time_ms_t* next_frame,
+                      bool* redrawn)
 {
     if (layer_get_hidden(layer)) {
         return false;
@@ -105,10 +128,35 @@ seconds_layer_animate(SecondsLayer* layer)
 
     seconds_info_t* info = get_info(layer);
     return info->number_layer
-           ? number_layer_animate(info->number_layer)
+           ? number_layer_animate(info->number_layer,
+                                  now,
+                                  next_frame,
+                                  redrawn)
            : false;
 }
 
+void
+seconds_layer_set_step_count(SecondsLayer* layer,
+                             unsigned step_count)
+{
+    seconds_info_t* info = get_info(layer);
+
+    if (info->number_layer) {
+        number_layer_set_step_count(info->number_layer,
+                                    step_count);
+    }
+}
+
+void
+seconds_layer_kill_anim(SecondsLayer* layer)
+{
+    seconds_info_t* info = get_info(layer);
+
+    if (info->number_layer) {
+        number_layer_kill_anim(info->number_layer);
+    }
+}
+
 void
 seconds_layer_set_time(SecondsLayer* layer,
                        unsigned seconds)
@@ -122,7 +170,8 @@ seconds_layer_set_time(SecondsLayer* layer,
     info->previous_seconds_value = seconds;
 
     if (info->number_layer) {
-        bool animate_seconds = cfg_get_seconds_style() != SECONDS_STYLE_FIXED;
+        bool animate_seconds = cfg_get_seconds_style() != SECONDS_STYLE_FIXED &&
+                               governor_can_animate();
 
         if (animate_seconds) {
             int prev_second = (seconds > 0)
@@ -152,9 +201,11 @@ seconds_layer_destroy(SecondsLayer* layer)
     if (info->number_layer) {
         number_layer_destroy(info->number_layer);
     } else {
-        inverter_layer_destroy(info->inverter_layer);
+        heap_inverter_layer_destroy(HEAP_WIDGETS,
+                                    info->inverter_layer);
     }
 
-    layer_destroy(layer);
+    heap_layer_destroy(HEAP_WIDGETS,
+                       layer);
 }
 
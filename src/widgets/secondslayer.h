@@ -12,6 +12,8 @@
 
 #include <pebble.h>
 
+#include "utils.h"
+
 // =======
 // TYPES =
 // =======
@@ -31,19 +33,44 @@ typedef Layer SecondsLayer;
 SecondsLayer*
 seconds_layer_create(void);
 
+/** Return the room taken in the layer data arena by the layer.
+ *
+ * This take all settings from the configuration. Return 0 if the layer is not
+ * enabled.
+ */
+size_t
+seconds_layer_get_data_size(void);
+
 /** Animate the layer (if required).
+ *
+ * See number_layer_animate() for details.
  *
  * @return true if more animation steps are needed, false otherwise.
  */
 bool
-seconds_layer_animate(SecondsLayer* layer);
+seconds_layer_animate(SecondsLayer* layer,
+                      time_ms_t now,
+                      time_ms_t* next_frame,
+                      bool* redrawn);
+
+/** Set the number of frames of each animation step.
+ *
+ * See number_layer_set_step_count().
+ */
+void
+seconds_layer_set_step_count(SecondsLayer* layer,
+                             unsigned step_count);
+
+/** Skip the running animation. */
+void
+seconds_layer_kill_anim(SecondsLayer* layer);
 
 /** Set the value to display */
 void
 seconds_layer_set_time(SecondsLayer* layer,
                        unsigned seconds);
 
-inline
+static inline
 void
 seconds_layer_set_hidden(SecondsLayer* layer,
                          bool hidden)